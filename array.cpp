@@ -1 +1,92 @@
 #include "array.hpp"
+
+#include <cstdlib>
+#include <type_traits>
+
+
+//---------------------------Compile-time checks-----------------------------------
+// Array is a literal aggregate: tables are computed by the compiler and checked here,
+// so a broken constexpr path fails the build of this file.
+
+constexpr Array<int, 10> squares_table()
+{
+    Array<int, 10> table{};
+    for (size_t index = 0; index < table.size(); ++index)
+    {
+        table[index] = static_cast<int> (index * index);
+    }
+
+    return table;
+}
+
+constexpr Array<int, 10> SQUARES = squares_table();
+
+static_assert(SQUARES[9] == 81);
+static_assert(SQUARES.at(3) == 9);
+static_assert(SQUARES == squares_table());
+static_assert(SQUARES != Array<int, 10>{});
+
+static_assert(Array<char, 3>{'a', 'b', 'c'} <  Array<char, 3>{'a', 'b', 'd'});
+static_assert(Array<char, 3>{'a', 'c', 'a'} >  Array<char, 3>{'a', 'b', 'z'});
+static_assert(Array<char, 3>{'a', 'b', 'c'} <= Array<char, 3>{'a', 'b', 'c'});
+
+constexpr bool fill_and_swap()
+{
+    Array<int, 4> first{1, 2, 3, 4};
+    Array<int, 4> second{};
+    second.fill(7);
+
+    first.swap(second);
+
+    return (first == Array<int, 4>{7, 7, 7, 7}) && (second == Array<int, 4>{1, 2, 3, 4});
+}
+
+static_assert(fill_and_swap());
+
+constexpr Array<bool, 70> every_third_bit()
+{
+    Array<bool, 70> bits{};
+    for (size_t index = 0; index < bits.size(); index += 3)
+    {
+        bits[index] = true;
+    }
+
+    return bits;
+}
+
+static_assert(every_third_bit().count() == 24);
+static_assert(every_third_bit().find_next(66) == 69);
+
+static_assert(std::is_trivially_copyable_v<Array<int, 4>>);
+static_assert(std::is_trivially_copyable_v<Array<bool, 70>>);
+
+
+//---------------------------Run-time comparison-----------------------------------
+// At run time arr_cmp takes memcmp, whose result can be any int; the operators must
+// still agree with the constant-evaluated byte loop on the same arrays.
+
+constexpr Array<char, 3> LOW  = {'a', 'b', 'c'};
+constexpr Array<char, 3> HIGH = {'a', 'b', 'z'};
+
+static_assert((LOW < HIGH) && (HIGH > LOW) && (LOW != HIGH) && (arr_cmp(LOW, HIGH) == -1));
+
+int main()
+{
+    volatile size_t index = 2;                                                      // keeps the arrays out of constant folding
+
+    Array<char, 3> low  = LOW;
+    Array<char, 3> high = LOW;
+    high[index] = 'z';
+
+    bool passed = (low < high) && (high > low) && (low <= high) && (high >= low) && (low != high) &&
+                  (arr_cmp(low, high) == -1) && (arr_cmp(high, low) == 1) && (arr_cmp(low, low) == 0);
+
+    if (!passed)
+    {
+        std::cerr << "ERROR: run-time Array comparison differs from the compile-time one" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -2,12 +2,15 @@
 #define ARRAY_HPP
 
 
+#include <bit>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <iostream>
+#include <type_traits>
 
 
-#define BANNED_COPYING_CONSTRUCTOR
+//#define BANNED_COPYING_CONSTRUCTOR                                                 // makes Array non trivially copyable
 //#define ELEM_TYPE_COMPARISON_OPERATORS
 
 enum class ArrayExceptions
@@ -20,142 +23,157 @@ enum class ArrayExceptions
 const size_t MAX_CAPACITY = 1024;
 
 
+// Aggregate without user-provided special members: trivially copyable for trivially
+// copyable Type and usable in constant expressions (Array<int, 3> table{1, 2, 3}).
 template <class Type, size_t Capacity>
 class Array
 {
 public:
 
-    Array()
-      : capacity_(Capacity)
-    {
-        for (size_t index = 0; index < Capacity; ++index)
-        {
-            data_[index * sizeof(Type)] = 0;
-        }
-    }
-
 #ifdef BANNED_COPYING_CONSTRUCTOR
+    Array() = default;
     Array(const Array &that) = delete;
+    Array &operator =(const Array &that) = default;
 #endif
 
-    ~Array(){};
-
 
-    Array &operator =(const Array &array)
+    constexpr size_t size() const
     {
-        for (size_t index = 0; index < array.capacity_; ++index)
-        {
-            size_t converted_index = index * sizeof(Type);
-            data_[converted_index] = array.data_[converted_index];
-        }
-
-        capacity_ = array.capacity_;
-
-        return *this;
+        return Capacity;
     }
 
-
-    size_t size() const
+    constexpr size_t max_size() const
     {
-        return capacity_;
+        return MAX_CAPACITY;
     }
 
-    size_t max_size() const
+    constexpr Type &operator [](size_t index)
     {
-        return MAX_CAPACITY;
+        return data_[index];
     }
 
-    Type &operator [](size_t index)
+    constexpr const Type &operator [](size_t index) const
     {
-        return data_[index * sizeof(Type)];
+        return data_[index];
     }
 
-    Type &at(const size_t index) const
+    constexpr Type &at(const size_t index)
     {
-        if (index < capacity_)
+        if (index < Capacity)
         {
-            return data_[index * sizeof(Type)];
+            return data_[index];
         }
 
         throw ArrayExceptions::INVALID_INDEX;
     }
 
-    Type *data() const
+    constexpr const Type &at(const size_t index) const
+    {
+        return const_cast<Array *> (this)->at(index);
+    }
+
+    constexpr Type *data()
     {
         return data_;
     }
 
-    void fill(const Type &value)
+    constexpr const Type *data() const
     {
-        for (size_t index = 0; index < capacity_; ++index)
-        {
-            data_[index * sizeof(Type)] = value;
-        }
+        return data_;
     }
 
-    void swap(Array &other)
+    constexpr Type *begin()
     {
-        if (capacity_ == other.capacity_)
-        {
-#ifdef BANNED_COPYING_CONSTRUCTOR
-            for (size_t index = 0; index < capacity_; ++index)
-            {
-                size_t converted_index = index * sizeof(Type);
+        return data_;
+    }
 
-                Type temp_elem = data_[converted_index];
-                data_[converted_index] = other.data_[converted_index];
-                other.data_[converted_index] = temp_elem;
-            }
+    constexpr const Type *begin() const
+    {
+        return data_;
+    }
 
-            size_t temp_capacity = capacity_;
-            capacity_ = other.capacity_;
-            other.capacity_ = temp_capacity;
+    constexpr Type *end()
+    {
+        return data_ + Capacity;
+    }
 
-#else
-            Array<Type, Capacity> temp = *this;
-            *this = other;
-            other = temp; 
-#endif
-        }
-        else
+    constexpr const Type *end() const
+    {
+        return data_ + Capacity;
+    }
+
+    constexpr void fill(const Type &value)
+    {
+        for (size_t index = 0; index < Capacity; ++index)
         {
-            throw ArrayExceptions::SWAP_ARRAYS_WITH_MISMATCHING_CAPACITIES;   
+            data_[index] = value;
         }
     }
 
-private:
+    constexpr void swap(Array &other)
+    {
+        for (size_t index = 0; index < Capacity; ++index)
+        {
+            Type temp_elem      = data_[index];
+            data_[index]        = other.data_[index];
+            other.data_[index]  = temp_elem;
+        }
+    }
 
-    size_t capacity_ = Capacity;
+//public for aggregate initialization
     Type data_[Capacity] = {};
 };
 
 
 #ifdef ELEM_TYPE_COMPARISON_OPERATORS
 template <class Type, size_t Capacity>
-int arr_cmp(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
+constexpr int arr_cmp(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
 {
-    size_t min = std::min(arr1.max_size(), arr2.max_size());
-    for (size_t index = 0; index < min; ++index)
+    for (size_t index = 0; index < Capacity; ++index)
     {
-        if (arr1.at(index) > arr2.at(index))
+        if (arr1[index] > arr2[index])
         {
             return 1;
         }
 
-        if (arr1.at(index) < arr2.at(index))
+        if (arr1[index] < arr2[index])
         {
             return -1;
         }
     }
 
-    if (arr1.max_size() > arr2.max_size())
+    return 0;
+}
+#else
+// memcmp over the elements at run time; in constant evaluation, where memcmp is not
+// allowed, std::bit_cast gives the same bytes to compare one by one.
+template <class Type, size_t Capacity>
+constexpr int arr_cmp(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
+{
+    if (!std::is_constant_evaluated())
     {
-        return 1;
+        int result = std::memcmp(arr1.data(), arr2.data(), sizeof(Type) * Capacity);
+
+        return (result > 0) - (result < 0);                                         // the operators expect -1, 0 or 1
     }
 
-    if (arr1.max_size() < arr2.max_size())
+    struct ElemBytes
+    {
+        unsigned char bytes[sizeof(Type)];
+    };
+
+    for (size_t index = 0; index < Capacity; ++index)
     {
-        return -1;
+        ElemBytes elem1 = std::bit_cast<ElemBytes> (arr1[index]);
+        ElemBytes elem2 = std::bit_cast<ElemBytes> (arr2[index]);
+
+        for (size_t byte = 0; byte < sizeof(Type); ++byte)
+        {
+            if (elem1.bytes[byte] != elem2.bytes[byte])
+            {
+                return elem1.bytes[byte] > elem2.bytes[byte] ? 1 : -1;
+            }
+        }
     }
 
     return 0;
@@ -163,70 +181,43 @@ int arr_cmp(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2
 #endif
 
 template <class Type, size_t Capacity>
-bool operator ==(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
+constexpr bool operator ==(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
 {
-#ifdef ELEM_TYPE_COMPARISON_OPERATORS
     return arr_cmp(arr1, arr2) == 0;
-#else
-    int result = memcmp(arr1.data(), arr2.data(), std::min(arr1.max_size(), arr2.max_size()) * sizeof(Type));
-    if ((!result) && (arr1.max_size() == arr2.max_size()))
-    {
-        return true;
-    }
-
-    return false;
-#endif
 }
 
 template <class Type, size_t Capacity>
-bool operator !=(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
+constexpr bool operator !=(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
 {
     return !(arr1 == arr2);
 }
 
 template <class Type, size_t Capacity>
-bool operator  <(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
+constexpr bool operator  <(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
 {
-#ifdef ELEM_TYPE_COMPARISON_OPERATORS
     return arr_cmp(arr1, arr2) == -1;
-#else
-    int result = memcmp(arr1.data(), arr2.data(), std::min(arr1.max_size(), arr2.max_size()) * sizeof(Type));
-    if ((result < 0) || ((result == 0) && (arr1.max_size() < arr2.max_size())))
-    {
-        return true;
-    }
-
-    return false;
-#endif
 }
 
 template <class Type, size_t Capacity>
-bool operator <=(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
+constexpr bool operator <=(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
 {
     return ((arr1 == arr2) || (arr1 < arr2));
 }
 
 template <class Type, size_t Capacity>
-bool operator >(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
+constexpr bool operator >(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
 {
-#ifdef ELEM_TYPE_COMPARISON_OPERATORS
     return arr_cmp(arr1, arr2) == 1;
-#else
-    int result = memcmp(arr1.data(), arr2.data(), std::min(arr1.max_size(), arr2.max_size()) * sizeof(Type));
-    if ((result > 0) || ((result == 0) && (arr1.max_size() > arr2.max_size())))
-    {
-        return true;
-    }
-
-    return false;
-#endif
 }
 
 template <class Type, size_t Capacity>
-bool operator >=(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
+constexpr bool operator >=(const Array<Type, Capacity> &arr1, const Array<Type, Capacity> &arr2)
 {
     return ((arr1 == arr2) || (arr1 > arr2));
 }
 
 
+#include "bit_array.hpp"
+
+
 #endif
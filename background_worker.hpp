@@ -0,0 +1,192 @@
+#ifndef BACKGROUND_WORKER_HPP
+#define BACKGROUND_WORKER_HPP
+
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include "ring_buffer.hpp"
+
+
+//---------------------------Class BackgroundWorker--------------------------------
+// A thread consuming jobs that any number of producers push into a bounded lock-free
+// queue. Consumer is default-constructed on the worker and gets every job through
+// consume(job), then batch_done() whenever the queue runs empty. A full queue refuses
+// the job instead of waiting, and so does a stopped worker: callers handle it themselves.
+
+enum class SubmitResult
+{
+    TAKEN,
+    FULL,
+    STOPPED
+};
+
+template <class Job, size_t Backlog, class Consumer>
+class BackgroundWorker
+{
+public:
+
+    BackgroundWorker()
+      : thread_(&BackgroundWorker::run, this)
+    {}
+
+    BackgroundWorker(const BackgroundWorker &that) = delete;
+    BackgroundWorker &operator =(const BackgroundWorker &that) = delete;
+
+    ~BackgroundWorker()
+    {
+        stop();
+    }
+
+    SubmitResult submit(const Job &job)
+    {
+        producers_.fetch_add(1);                                                    // seq_cst, pairs with stop()
+        if (stopping_.load())
+        {
+            leave_producer();
+
+            return SubmitResult::STOPPED;
+        }
+
+        bool taken = queue_.try_push(job);
+        if (taken)
+        {
+            submitted_.fetch_add(1, std::memory_order_release);
+            wake_epoch_.fetch_add(1, std::memory_order_release);
+            wake_epoch_.notify_one();
+        }
+
+        leave_producer();
+
+        return taken ? SubmitResult::TAKEN : SubmitResult::FULL;
+    }
+
+    // Blocks until every job submitted before the call has been consumed.
+    void drain()
+    {
+        size_t target = submitted_.load(std::memory_order_acquire);
+        size_t done   = completed_.load(std::memory_order_acquire);
+        while (done < target)
+        {
+            completed_.wait(done, std::memory_order_acquire);
+            done = completed_.load(std::memory_order_acquire);
+        }
+    }
+
+    size_t backlog() const
+    {
+        return queue_.size();
+    }
+
+    // Consumes the jobs already taken and joins the thread; later submits get STOPPED.
+    void stop()
+    {
+        if (stopping_.exchange(true))
+        {
+            return;
+        }
+
+        // A producer that saw stopping_ unset may still be pushing; the final drain
+        // of the worker has to consume its job, or drain() would wait for it forever.
+        for (size_t active = producers_.load(); active != 0; active = producers_.load())
+        {
+            producers_.wait(active);
+        }
+
+        closed_.store(true, std::memory_order_release);
+        wake_epoch_.fetch_add(1, std::memory_order_release);
+        wake_epoch_.notify_one();
+
+        thread_.join();
+    }
+
+private:
+
+    void leave_producer()
+    {
+        if ((producers_.fetch_sub(1) == 1) && (stopping_.load()))
+        {
+            producers_.notify_all();
+        }
+    }
+
+    void run()
+    {
+        Consumer consumer;
+
+        for (;;)
+        {
+            size_t epoch = wake_epoch_.load(std::memory_order_acquire);
+
+            Job job;
+            bool consumed = false;
+            while (queue_.try_pop(job))
+            {
+                consumer.consume(job);
+                consumed = true;
+
+                completed_.fetch_add(1, std::memory_order_release);
+                completed_.notify_all();
+            }
+
+            if (consumed)
+            {
+                consumer.batch_done();
+            }
+
+            if ((closed_.load(std::memory_order_acquire)) && (queue_.size() == 0))
+            {
+                return;
+            }
+
+            wake_epoch_.wait(epoch, std::memory_order_acquire);
+        }
+    }
+
+    RingBuffer<Job, Backlog> queue_;
+
+    std::atomic<size_t> submitted_{0};
+    std::atomic<size_t> completed_{0};
+    std::atomic<size_t> wake_epoch_{0};
+    std::atomic<size_t> producers_{0};                                              // inside submit() right now
+    std::atomic<bool>   stopping_{false};                                           // submit() refuses jobs
+    std::atomic<bool>   closed_{false};                                             // stopping_ and no producers left
+
+    std::thread thread_;
+};
+
+
+//---------------------------Process-wide instance---------------------------------
+// The one Service of the process (it needs a stop()), created on first use. Once
+// static destruction has stopped it, returns nullptr, so callers running from other
+// static destructors fall back to doing the work themselves.
+
+template <class Service>
+constinit std::atomic<bool> process_instance_destroyed{false};                     // valid through all of static destruction
+
+template <class Service>
+Service *process_instance()
+{
+    struct Holder
+    {
+        ~Holder()
+        {
+            service_.stop();
+            process_instance_destroyed<Service>.store(true, std::memory_order_release);
+        }
+
+        Service service_;
+    };
+
+    if (process_instance_destroyed<Service>.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    static Holder holder;
+
+    return &holder.service_;
+}
+
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef BIT_ARRAY_HPP
+#define BIT_ARRAY_HPP
+
+
+#include "array.hpp"
+#include "bit_kernels.hpp"
+
+
+//---------------------------Class Array<bool>-------------------------------------
+// Packs flags into 64-bit words, bits past Capacity are always kept zero.
+// Like Array, it is a trivially copyable aggregate usable in constant expressions.
+template <size_t Capacity>
+class Array<bool, Capacity>
+{
+public:
+
+    using Reference = BitReference;
+
+#ifdef BANNED_COPYING_CONSTRUCTOR
+    Array() = default;
+    Array(const Array &that) = delete;
+    Array &operator =(const Array &that) = default;
+#endif
+
+
+    constexpr size_t size() const
+    {
+        return Capacity;
+    }
+
+    constexpr size_t max_size() const
+    {
+        return MAX_CAPACITY;
+    }
+
+    constexpr Reference operator [](size_t index)
+    {
+        return Reference(&words_[index / BITS_PER_WORD], bit_mask(index));
+    }
+
+    constexpr bool operator [](size_t index) const
+    {
+        return test(index);
+    }
+
+    constexpr Reference at(const size_t index)
+    {
+        if (index < Capacity)
+        {
+            return this->operator[](index);
+        }
+
+        throw ArrayExceptions::INVALID_INDEX;
+    }
+
+    constexpr bool at(const size_t index) const
+    {
+        return const_cast<Array *> (this)->at(index);
+    }
+
+    constexpr bool test(const size_t index) const
+    {
+        return (words_[index / BITS_PER_WORD] & bit_mask(index)) != 0;
+    }
+
+    constexpr const uint64_t *data() const
+    {
+        return words_;
+    }
+
+    constexpr uint64_t *data()
+    {
+        return words_;
+    }
+
+    constexpr void fill(const bool value)
+    {
+        for (size_t index = 0; index < WORD_COUNT; ++index)
+        {
+            words_[index] = value ? ALL_BITS : 0;
+        }
+
+        clear_tail();
+    }
+
+    constexpr void swap(Array &other)
+    {
+        for (size_t index = 0; index < WORD_COUNT; ++index)
+        {
+            uint64_t temp_word   = words_[index];
+            words_[index]        = other.words_[index];
+            other.words_[index]  = temp_word;
+        }
+    }
+
+    constexpr size_t count() const
+    {
+        return popcount_words(words_, WORD_COUNT);
+    }
+
+    constexpr size_t find_first() const
+    {
+        return find_next_set_bit(words_, Capacity, 0);
+    }
+
+    // Returns index of the first set bit after index, size() if there is none.
+    constexpr size_t find_next(const size_t index) const
+    {
+        return find_next_set_bit(words_, Capacity, index + 1);
+    }
+
+    constexpr Array &operator &=(const Array &other)
+    {
+        and_words(words_, other.words_, WORD_COUNT);
+
+        return *this;
+    }
+
+    constexpr Array &operator |=(const Array &other)
+    {
+        or_words(words_, other.words_, WORD_COUNT);
+
+        return *this;
+    }
+
+    constexpr Array &operator ^=(const Array &other)
+    {
+        xor_words(words_, other.words_, WORD_COUNT);
+
+        return *this;
+    }
+
+    // this &= ~other
+    constexpr Array &andnot(const Array &other)
+    {
+        andnot_words(words_, other.words_, WORD_COUNT);
+
+        return *this;
+    }
+
+private:
+
+    // Array<bool, 0> still has one word, and none of its bits are used.
+    constexpr void clear_tail()
+    {
+        words_[WORD_COUNT - 1] &= Capacity == 0 ? 0 : tail_mask(Capacity);
+    }
+
+    static const size_t WORD_COUNT = Capacity == 0 ? 1 : (Capacity + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+public:
+//public for aggregate initialization
+    uint64_t words_[WORD_COUNT] = {};
+};
+
+
+// Lexicographic comparison by bit index: the first differing bit decides.
+template <size_t Capacity>
+constexpr int bit_arr_cmp(const Array<bool, Capacity> &arr1, const Array<bool, Capacity> &arr2)
+{
+    size_t first_diff = Capacity;
+    for (size_t word_index = 0; word_index * BITS_PER_WORD < Capacity; ++word_index)
+    {
+        uint64_t diff = arr1.data()[word_index] ^ arr2.data()[word_index];
+        if (diff != 0)
+        {
+            first_diff = word_index * BITS_PER_WORD + static_cast<size_t> (std::countr_zero(diff));
+            break;
+        }
+    }
+
+    if (first_diff == Capacity)
+    {
+        return 0;
+    }
+
+    return arr1[first_diff] ? 1 : -1;
+}
+
+template <size_t Capacity>
+constexpr bool operator ==(const Array<bool, Capacity> &arr1, const Array<bool, Capacity> &arr2)
+{
+    return bit_arr_cmp(arr1, arr2) == 0;
+}
+
+template <size_t Capacity>
+constexpr bool operator !=(const Array<bool, Capacity> &arr1, const Array<bool, Capacity> &arr2)
+{
+    return bit_arr_cmp(arr1, arr2) != 0;
+}
+
+template <size_t Capacity>
+constexpr bool operator  <(const Array<bool, Capacity> &arr1, const Array<bool, Capacity> &arr2)
+{
+    return bit_arr_cmp(arr1, arr2) < 0;
+}
+
+template <size_t Capacity>
+constexpr bool operator <=(const Array<bool, Capacity> &arr1, const Array<bool, Capacity> &arr2)
+{
+    return bit_arr_cmp(arr1, arr2) <= 0;
+}
+
+template <size_t Capacity>
+constexpr bool operator >(const Array<bool, Capacity> &arr1, const Array<bool, Capacity> &arr2)
+{
+    return bit_arr_cmp(arr1, arr2) > 0;
+}
+
+template <size_t Capacity>
+constexpr bool operator >=(const Array<bool, Capacity> &arr1, const Array<bool, Capacity> &arr2)
+{
+    return bit_arr_cmp(arr1, arr2) >= 0;
+}
+
+
+#endif
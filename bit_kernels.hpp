@@ -0,0 +1,193 @@
+#ifndef BIT_KERNELS_HPP
+#define BIT_KERNELS_HPP
+
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+
+//---------------------------Const section-----------------------------------------
+const size_t BITS_PER_WORD = 64;
+const uint64_t ALL_BITS    = ~static_cast<uint64_t> (0);
+
+
+//---------------------------Word arithmetic---------------------------------------
+
+constexpr size_t words_for_bits(size_t bit_count)
+{
+    return (bit_count + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+constexpr uint64_t bit_mask(size_t bit_index)
+{
+    return static_cast<uint64_t> (1) << (bit_index % BITS_PER_WORD);
+}
+
+// Mask of the bits of the last word that are below bit_count (all bits if the word is full).
+constexpr uint64_t tail_mask(size_t bit_count)
+{
+    size_t used_bits = bit_count % BITS_PER_WORD;
+
+    return used_bits == 0 ? ALL_BITS : (bit_mask(used_bits) - 1);
+}
+
+//---------------------------Bulk kernels------------------------------------------
+// Plain word loops: the bitwise ones are vectorized by the compiler. std::popcount
+// only becomes the popcnt instruction when the target has it (-mpopcnt, -march=native),
+// otherwise it is a library call per word, so on x86 without it popcount_words checks
+// the CPU once and runs a copy of the loop compiled for popcnt.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(__POPCNT__)
+#define POPCNT_DISPATCH
+#endif
+
+#ifdef POPCNT_DISPATCH
+__attribute__((target("popcnt")))
+inline size_t popcount_words_popcnt(const uint64_t *words, size_t word_count)
+{
+    size_t result = 0;
+    for (size_t index = 0; index < word_count; ++index)
+    {
+        result += static_cast<size_t> (__builtin_popcountll(words[index]));
+    }
+
+    return result;
+}
+
+inline bool cpu_has_popcnt()
+{
+    static const bool has_popcnt = (__builtin_cpu_init(), __builtin_cpu_supports("popcnt"));
+
+    return has_popcnt;
+}
+#endif
+
+constexpr size_t popcount_words(const uint64_t *words, size_t word_count)
+{
+#ifdef POPCNT_DISPATCH
+    if ((!std::is_constant_evaluated()) && (cpu_has_popcnt()))
+    {
+        return popcount_words_popcnt(words, word_count);
+    }
+#endif
+
+    size_t result = 0;
+    for (size_t index = 0; index < word_count; ++index)
+    {
+        result += static_cast<size_t> (std::popcount(words[index]));
+    }
+
+    return result;
+}
+
+// Returns index of the first set bit at or after from, bit_count if there is none.
+constexpr size_t find_next_set_bit(const uint64_t *words, size_t bit_count, size_t from)
+{
+    if (from >= bit_count)
+    {
+        return bit_count;
+    }
+
+    size_t word_count = words_for_bits(bit_count);
+    size_t word_index = from / BITS_PER_WORD;
+    uint64_t word     = words[word_index] & ~(bit_mask(from) - 1);
+
+    while (word == 0)
+    {
+        if (++word_index == word_count)
+        {
+            return bit_count;
+        }
+
+        word = words[word_index];
+    }
+
+    size_t found = word_index * BITS_PER_WORD + static_cast<size_t> (std::countr_zero(word));
+
+    return found < bit_count ? found : bit_count;
+}
+
+constexpr void and_words(uint64_t *dest, const uint64_t *src, size_t word_count)
+{
+    for (size_t index = 0; index < word_count; ++index)
+    {
+        dest[index] &= src[index];
+    }
+}
+
+constexpr void or_words(uint64_t *dest, const uint64_t *src, size_t word_count)
+{
+    for (size_t index = 0; index < word_count; ++index)
+    {
+        dest[index] |= src[index];
+    }
+}
+
+constexpr void xor_words(uint64_t *dest, const uint64_t *src, size_t word_count)
+{
+    for (size_t index = 0; index < word_count; ++index)
+    {
+        dest[index] ^= src[index];
+    }
+}
+
+constexpr void andnot_words(uint64_t *dest, const uint64_t *src, size_t word_count)
+{
+    for (size_t index = 0; index < word_count; ++index)
+    {
+        dest[index] &= ~src[index];
+    }
+}
+
+//---------------------------Bit reference-----------------------------------------
+
+class BitReference
+{
+public:
+
+    constexpr BitReference(uint64_t *word, uint64_t mask)
+      : word_(word),
+        mask_(mask)
+    {}
+
+    constexpr BitReference(const BitReference &other) = default;
+
+    constexpr operator bool() const
+    {
+        return (*word_ & mask_) != 0;
+    }
+
+    constexpr BitReference &operator =(bool value)
+    {
+        if (value)
+        {
+            *word_ |= mask_;
+        }
+        else
+        {
+            *word_ &= ~mask_;
+        }
+
+        return *this;
+    }
+
+    constexpr BitReference &operator =(const BitReference &other)
+    {
+        return *this = static_cast<bool> (other);
+    }
+
+    constexpr void flip()
+    {
+        *word_ ^= mask_;
+    }
+
+private:
+
+    uint64_t *word_ = nullptr;
+    uint64_t  mask_ = 0;
+};
+
+
+#endif
@@ -0,0 +1,514 @@
+#ifndef BIT_VECTOR_HPP
+#define BIT_VECTOR_HPP
+
+
+#include <memory>
+#include "bit_kernels.hpp"
+#include "vector.hpp"
+
+
+//---------------------------Class Vector<bool>------------------------------------
+// Packs flags into 64-bit words. Bits past size_ are always kept zero,
+// so bulk kernels can work on whole words without masking. Storage goes through
+// std::allocator, so it is usable in constant expressions like Vector.
+template <>
+class Vector<bool>
+{
+public:
+
+    using Reference = BitReference;
+
+//--------------------Constructors, destructors and =------------------------------
+    constexpr Vector() = default;
+
+    constexpr Vector(const size_t reserved_size, const bool value = false)
+    {
+        if (reserved_size != 0)
+        {
+            allocate_words(calculate_enough_capacity(reserved_size));
+
+            size_ = reserved_size;
+            if (value)
+            {
+                fill_words(0, words_for_bits(size_), ALL_BITS);
+                words_[words_for_bits(size_) - 1] &= tail_mask(size_);
+            }
+        }
+    }
+
+    constexpr ~Vector()
+    {
+        free_words(words_, capacity_);
+
+        destroy_fields();
+    }
+
+    constexpr Vector(const Vector &other)
+    {
+        if (other.capacity_ != 0)
+        {
+            allocate_words(other.capacity_);
+            copy_words(words_, other.words_, words_for_bits(other.capacity_));
+        }
+
+        size_ = other.size_;
+    }
+
+    constexpr Vector(Vector &&other) noexcept
+      : capacity_(other.capacity_),
+        size_    (other.size_),
+        words_   (other.words_)
+    {
+        other.capacity_ = 0;
+        other.size_     = 0;
+        other.words_    = nullptr;
+    }
+
+    // Takes other by value, so assigning an rvalue moves it in.
+    constexpr Vector &operator =(Vector other) noexcept
+    {
+        this->swap(other);
+
+        return *this;
+    }
+
+//----------------------------------Dump-------------------------------------------
+
+    void dump(size_t from = 0, size_t to = VECTOR_MAX_CAPACITY + 1) const
+    {
+        if (to == VECTOR_MAX_CAPACITY + 1)
+        {
+            to = size_;
+        }
+
+        std::cout << "Vector<bool>[" << this << "]" << std::endl;
+        std::cout << "capacity_: " << capacity_ << std::endl;
+        std::cout << "size_: " << size_ << std::endl << std::endl;
+
+        for (; from < to; ++from)
+        {
+            std::cout << test(from);
+        }
+
+        std::cout << std::endl << std::endl;
+    }
+
+//---------------------------Size and capacity-------------------------------------
+
+    constexpr bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    constexpr size_t size() const
+    {
+        return size_;
+    }
+
+    constexpr size_t max_size() const
+    {
+        return VECTOR_MAX_CAPACITY;
+    }
+
+    constexpr size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    constexpr void reserve(size_t reserved_size)
+    {
+        if (reserved_size <= capacity_)
+        {
+            return;
+        }
+
+        reallocate_words(reserved_size);
+    }
+
+    constexpr void shrink_to_fit()
+    {
+        if (words_for_bits(capacity_) == words_for_bits(size_))
+        {
+            return;
+        }
+
+        reallocate_words(size_);
+    }
+
+//-----------------------------Operating elements----------------------------------
+
+    constexpr bool operator [](const size_t index) const
+    {
+        return test(index);
+    }
+
+    constexpr Reference operator [](const size_t index)
+    {
+        assert(index < capacity_);
+
+        return Reference(&words_[index / BITS_PER_WORD], bit_mask(index));
+    }
+
+    constexpr bool at(const size_t index) const
+    {
+        return const_cast<Vector *> (this)->at(index);
+    }
+
+    constexpr Reference at(const size_t index)
+    {
+        if (index < size_)
+        {
+            return this->operator[](index);
+        }
+
+        REPORT_EVENT(DiagCode::GET_OUT_OF_BOUNDS, index, size_);
+
+        throw std::out_of_range("ERROR: attempt to get value out of bounds");
+    }
+
+    constexpr bool test(const size_t index) const
+    {
+        return (words_[index / BITS_PER_WORD] & bit_mask(index)) != 0;
+    }
+
+    constexpr void set(const size_t index, const bool value = true)
+    {
+        this->operator[](index) = value;
+    }
+
+    constexpr void flip(const size_t index)
+    {
+        this->operator[](index).flip();
+    }
+
+    constexpr bool front() const
+    {
+        return test(0);
+    }
+
+    constexpr Reference front()
+    {
+        return this->operator[](0);
+    }
+
+    constexpr bool back() const
+    {
+        return test(size_ - 1);
+    }
+
+    constexpr Reference back()
+    {
+        return this->operator[](size_ - 1);
+    }
+
+    constexpr const uint64_t *data() const
+    {
+        return words_;
+    }
+
+    constexpr uint64_t *data()
+    {
+        return words_;
+    }
+
+    constexpr size_t word_count() const
+    {
+        return words_for_bits(size_);
+    }
+
+//---------------------------Bulk operations---------------------------------------
+
+    constexpr size_t count() const
+    {
+        return popcount_words(words_, word_count());
+    }
+
+    constexpr size_t find_first() const
+    {
+        return find_next_set_bit(words_, size_, 0);
+    }
+
+    // Returns index of the first set bit after index, size() if there is none.
+    constexpr size_t find_next(const size_t index) const
+    {
+        return find_next_set_bit(words_, size_, index + 1);
+    }
+
+    constexpr void flip()
+    {
+        for (size_t index = 0; index < word_count(); ++index)
+        {
+            words_[index] = ~words_[index];
+        }
+
+        clear_tail();
+    }
+
+    constexpr Vector &operator &=(const Vector &other)
+    {
+        check_same_size(other);
+        and_words(words_, other.words_, word_count());
+
+        return *this;
+    }
+
+    constexpr Vector &operator |=(const Vector &other)
+    {
+        check_same_size(other);
+        or_words(words_, other.words_, word_count());
+
+        return *this;
+    }
+
+    constexpr Vector &operator ^=(const Vector &other)
+    {
+        check_same_size(other);
+        xor_words(words_, other.words_, word_count());
+
+        return *this;
+    }
+
+    // this &= ~other
+    constexpr Vector &andnot(const Vector &other)
+    {
+        check_same_size(other);
+        andnot_words(words_, other.words_, word_count());
+
+        return *this;
+    }
+
+//---------------------------Modifiers---------------------------------------------
+
+    constexpr void clear()
+    {
+        fill_words(0, word_count(), 0);
+
+        size_ = 0;
+    }
+
+    constexpr Reference insert(size_t index, const bool value)
+    {
+        if (index > size_)
+        {
+            REPORT_EVENT(DiagCode::INSERT_OUT_OF_BOUNDS, index, size_);
+
+            throw std::out_of_range("ERROR: attempt to insert out of bounds");
+        }
+
+        if (size_ == capacity_)
+        {
+            reallocate_words(calculate_enough_capacity(size_ + 1));
+        }
+
+        ++size_;
+
+        size_t first_word = index / BITS_PER_WORD;
+        for (size_t word_index = word_count() - 1; word_index > first_word; --word_index)
+        {
+            words_[word_index] = (words_[word_index] << 1) | (words_[word_index - 1] >> (BITS_PER_WORD - 1));
+        }
+
+        uint64_t low_bits = bit_mask(index) - 1;
+        words_[first_word] = (words_[first_word] & low_bits) | ((words_[first_word] & ~low_bits) << 1);
+
+        Reference inserted = this->operator[](index);
+        inserted = value;
+
+        return inserted;
+    }
+
+    constexpr Reference erase(size_t index)
+    {
+        if (index >= size_)
+        {
+            REPORT_EVENT(DiagCode::ERASE_OUT_OF_BOUNDS, index, size_);
+
+            throw std::out_of_range("ERROR: attempt to erase out of bounds");
+        }
+
+        size_t first_word = index / BITS_PER_WORD;
+        size_t last_word  = word_count() - 1;
+
+        uint64_t low_bits = bit_mask(index) - 1;
+        words_[first_word] = (words_[first_word] & low_bits) | ((words_[first_word] >> 1) & ~low_bits);
+
+        for (size_t word_index = first_word; word_index < last_word; ++word_index)
+        {
+            words_[word_index]     |= words_[word_index + 1] << (BITS_PER_WORD - 1);
+            words_[word_index + 1] >>= 1;
+        }
+
+        --size_;
+
+        return this->operator[](index);
+    }
+
+    constexpr void push_back(const bool value)
+    {
+        if (size_ == capacity_)
+        {
+            reallocate_words(calculate_enough_capacity(size_ + 1));
+        }
+
+        ++size_;
+        set(size_ - 1, value);
+    }
+
+    constexpr void pop_back()
+    {
+        if (size_ == 0)
+        {
+            return;
+        }
+
+        set(size_ - 1, false);
+        --size_;
+    }
+
+    constexpr void resize(size_t new_size, const bool value = false)
+    {
+        if (new_size <= size_)
+        {
+            size_ = new_size;
+            clear_tail();
+            fill_words(word_count(), words_for_bits(capacity_), 0);
+
+            return;
+        }
+
+        if (new_size > capacity_)
+        {
+            reallocate_words(calculate_enough_capacity(new_size));
+        }
+
+        if (value)
+        {
+            size_t old_size = size_;
+            size_ = new_size;
+
+            if (old_size % BITS_PER_WORD != 0)
+            {
+                words_[old_size / BITS_PER_WORD] |= ~tail_mask(old_size);
+            }
+            fill_words(words_for_bits(old_size), word_count(), ALL_BITS);
+            clear_tail();
+        }
+        else
+        {
+            size_ = new_size;
+        }
+    }
+
+    constexpr void swap(Vector &other) noexcept
+    {
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(words_, other.words_);
+    }
+
+private:
+//--------------------------Utility functions--------------------------------------
+
+    constexpr void allocate_words(size_t bit_capacity)
+    {
+        size_t word_capacity = words_for_bits(bit_capacity);
+        try
+        {
+            words_ = word_capacity == 0 ? nullptr : std::allocator<uint64_t>().allocate(word_capacity);
+        }
+        catch (...)
+        {
+            REPORT_EVENT(DiagCode::NOT_ALLOCATED, word_capacity * BITS_PER_WORD);
+
+            throw;
+        }
+
+        capacity_ = word_capacity * BITS_PER_WORD;
+        fill_words(0, word_capacity, 0);
+    }
+
+    static constexpr void free_words(uint64_t *words, size_t bit_capacity)
+    {
+        if (words != nullptr)
+        {
+            std::allocator<uint64_t>().deallocate(words, words_for_bits(bit_capacity));
+        }
+    }
+
+    constexpr void reallocate_words(size_t bit_capacity)
+    {
+        uint64_t *old_words = words_;
+        size_t old_count    = word_count();
+        size_t old_capacity = capacity_;
+
+        try
+        {
+            allocate_words(bit_capacity);
+        }
+        catch (...)
+        {
+            REPORT_EVENT(DiagCode::ALLOCATION_FAILED, bit_capacity);
+
+            throw;
+        }
+
+        copy_words(words_, old_words, old_count);
+
+        free_words(old_words, old_capacity);
+    }
+
+    constexpr void fill_words(size_t from, size_t to, uint64_t value)
+    {
+        for (size_t index = from; index < to; ++index)
+        {
+            words_[index] = value;
+        }
+    }
+
+    static constexpr void copy_words(uint64_t *dest, const uint64_t *src, size_t quantity)
+    {
+        for (size_t index = 0; index < quantity; ++index)
+        {
+            dest[index] = src[index];
+        }
+    }
+
+    constexpr void clear_tail()
+    {
+        if (size_ % BITS_PER_WORD != 0)
+        {
+            words_[size_ / BITS_PER_WORD] &= tail_mask(size_);
+        }
+    }
+
+    constexpr void check_same_size(const Vector &other) const
+    {
+        if (size_ != other.size_)
+        {
+            REPORT_EVENT(DiagCode::SIZE_MISMATCH, size_, other.size_);
+
+            throw std::length_error("ERROR: bitwise operation on vectors of different sizes");
+        }
+    }
+
+    constexpr void destroy_fields()
+    {
+        capacity_ = POISONED_SIZE_T;
+        size_     = POISONED_SIZE_T;
+        words_    = nullptr;
+    }
+
+private:
+//----------------------------Variables--------------------------------------------
+
+    size_t capacity_ = 0;                                                           // in bits, always a multiple of BITS_PER_WORD
+    size_t size_     = 0;
+
+    uint64_t *words_ = nullptr;
+};
+
+
+using BitVector = Vector<bool>;
+
+
+#endif
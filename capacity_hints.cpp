@@ -0,0 +1,196 @@
+#include "capacity_hints.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include "hash.hpp"
+
+
+//---------------------------Struct CapacitySite-----------------------------------
+
+struct CapacitySite
+{
+    std::atomic<uint64_t> key_{0};                                                  // 0 while the slot is free
+    std::atomic<bool>     ready_{false};                                            // location is written
+
+    const char *file_ = nullptr;
+    const char *func_ = nullptr;
+    int         line_ = 0;
+
+    std::atomic<uint32_t> buckets_[2][CAPACITY_HINT_BUCKETS] = {};                  // the current window and the one before
+    std::atomic<uint32_t> window_{0};                                               // its low bit selects the current one
+    std::atomic<uint32_t> window_samples_{0};
+};
+
+// Zero-initialized, so it is ready before any static object is constructed.
+static CapacitySite capacity_sites[CAPACITY_HINT_SITES];
+
+
+static uint64_t location_key(const Location &location)
+{
+    uint64_t key = hash_bytes(location.file_, std::strlen(location.file_), static_cast<uint64_t> (location.line_));
+
+    return key == 0 ? 1 : key;
+}
+
+static bool same_location(const CapacitySite &site, const Location &location)
+{
+    while (!site.ready_.load(std::memory_order_acquire))                            // the claiming thread is writing it
+    {
+    }
+
+    return (site.line_ == location.line_) && (std::strcmp(site.file_, location.file_) == 0);
+}
+
+// Open addressing with linear probing; slots are claimed with a CAS on the key.
+CapacitySite *capacity_site(const Location &location)
+{
+    uint64_t key = location_key(location);
+
+    for (size_t probe = 0; probe < CAPACITY_HINT_SITES; ++probe)
+    {
+        CapacitySite &site = capacity_sites[(key + probe) % CAPACITY_HINT_SITES];
+
+        uint64_t current = site.key_.load(std::memory_order_acquire);
+        if (current == 0)
+        {
+            if (site.key_.compare_exchange_strong(current, key, std::memory_order_acq_rel))
+            {
+                site.file_ = location.file_;
+                site.func_ = location.func_;
+                site.line_ = location.line_;
+                site.ready_.store(true, std::memory_order_release);
+
+                return &site;
+            }
+        }
+
+        if ((current == key) && (same_location(site, location)))
+        {
+            return &site;
+        }
+    }
+
+    return nullptr;
+}
+
+void record_final_size(CapacitySite *site, size_t size)
+{
+    uint32_t window = site->window_.load(std::memory_order_relaxed);
+    site->buckets_[window & 1][std::bit_width(size)].fetch_add(1, std::memory_order_relaxed);
+
+    if (site->window_samples_.fetch_add(1, std::memory_order_relaxed) + 1 != CAPACITY_HINT_WINDOW)
+    {
+        return;
+    }
+
+    // Only the thread that completed the window starts the next one, in the slot of the
+    // oldest window. A sample racing with the switch may land in either window or be
+    // cleared with the old one, which a histogram of typical sizes can afford.
+    site->window_samples_.store(0, std::memory_order_relaxed);
+    for (size_t bucket = 0; bucket < CAPACITY_HINT_BUCKETS; ++bucket)
+    {
+        site->buckets_[(window + 1) & 1][bucket].store(0, std::memory_order_relaxed);
+    }
+    site->window_.store(window + 1, std::memory_order_relaxed);
+}
+
+// Samples of both windows, per bucket; returns their total.
+static uint64_t site_counts(const CapacitySite *site, uint32_t (&counts)[CAPACITY_HINT_BUCKETS])
+{
+    uint64_t total = 0;
+    for (size_t bucket = 0; bucket < CAPACITY_HINT_BUCKETS; ++bucket)
+    {
+        counts[bucket] = site->buckets_[0][bucket].load(std::memory_order_relaxed) +
+                         site->buckets_[1][bucket].load(std::memory_order_relaxed);
+        total += counts[bucket];
+    }
+
+    return total;
+}
+
+size_t capacity_hint(const CapacitySite *site)
+{
+    uint32_t counts[CAPACITY_HINT_BUCKETS] = {};
+    uint64_t total = site_counts(site, counts);
+
+    if (total < CAPACITY_HINT_MIN_SAMPLES)
+    {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t> (std::ceil(CAPACITY_HINT_PERCENTILE * static_cast<double> (total)));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < CAPACITY_HINT_BUCKETS; ++bucket)
+    {
+        seen += counts[bucket];
+        if (seen >= rank)
+        {
+            if (bucket == 0)
+            {
+                return 0;
+            }
+
+            return bucket >= static_cast<size_t> (std::bit_width(CAPACITY_HINT_MAX)) ? CAPACITY_HINT_MAX : static_cast<size_t> (1) << bucket;
+        }
+    }
+
+    return CAPACITY_HINT_MAX;
+}
+
+// Characters that cannot be in an identifier become '_'.
+static void write_identifier(std::ostream &stream, const char *from, const char *to)
+{
+    for (; from != to; ++from)
+    {
+        stream << (std::isalnum(static_cast<unsigned char> (*from)) ? *from : '_');
+    }
+}
+
+void export_capacity_hints(std::ostream &stream)
+{
+    for (size_t index = 0; index < CAPACITY_HINT_SITES; ++index)
+    {
+        const CapacitySite &site = capacity_sites[index];
+        if (!site.ready_.load(std::memory_order_acquire))
+        {
+            continue;
+        }
+
+        size_t hint = capacity_hint(&site);
+        if (hint == 0)
+        {
+            continue;
+        }
+
+        uint32_t counts[CAPACITY_HINT_BUCKETS] = {};
+        uint64_t samples = site_counts(&site, counts);
+
+        // The file stem keeps names apart for functions of the same name in different files.
+        const char *stem     = site.file_;
+        const char *stem_end = nullptr;
+        for (const char *symbol = site.file_; *symbol != '\0'; ++symbol)
+        {
+            if ((*symbol == '/') || (*symbol == '\\'))
+            {
+                stem     = symbol + 1;
+                stem_end = nullptr;
+            }
+            else if (*symbol == '.')
+            {
+                stem_end = symbol;
+            }
+        }
+
+        stream << "const size_t RESERVE_HINT_";
+        write_identifier(stream, stem, stem_end == nullptr ? stem + std::strlen(stem) : stem_end);
+        stream << "_";
+        write_identifier(stream, site.func_, site.func_ + std::strlen(site.func_));
+
+        stream << "_" << site.line_ << " = " << hint << ";\t// " << site.file_ << ", " << samples << " samples\n";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef CAPACITY_HINTS_HPP
+#define CAPACITY_HINTS_HPP
+
+
+#include <cstddef>
+#include <iosfwd>
+#include "location.hpp"
+
+
+//---------------------------Capacity hints----------------------------------------
+// Containers built at the same place usually end up about the same size. A site
+// keeps a log2 histogram of the final sizes reported for it, and new containers
+// from that site reserve the CAPACITY_HINT_PERCENTILE of them up front instead of
+// growing step by step. Everything is atomic counters, no locks.
+//
+// Limits: at most CAPACITY_HINT_SITES sites (later ones get no hints), and hints never
+// exceed CAPACITY_HINT_MAX elements. A site only keeps its last two windows of
+// CAPACITY_HINT_WINDOW samples: older sizes are dropped, not faded, so after the
+// workload changes the hint follows within 2 * CAPACITY_HINT_WINDOW samples.
+
+const size_t CAPACITY_HINT_SITES        = 1024;
+const size_t CAPACITY_HINT_BUCKETS      = 65;                                       // bucket b holds sizes in [2^(b - 1), 2^b)
+const size_t CAPACITY_HINT_MIN_SAMPLES  = 8;
+const size_t CAPACITY_HINT_WINDOW       = 128;
+const size_t CAPACITY_HINT_MAX          = static_cast<size_t> (1) << 24;
+const double CAPACITY_HINT_PERCENTILE   = 0.95;
+
+
+struct CapacitySite;
+
+// Finds or claims the site for location. Returns nullptr when the table is full.
+CapacitySite *capacity_site(const Location &location);
+
+struct CapacitySiteRef
+{
+    CapacitySite *site_ = nullptr;
+};
+
+// The site of the place where it is written: capacity_site() hashes the file name,
+// so its result is kept in a static of that place and looked up only once.
+#define CAPACITY_SITE [](const Location &location)                                      \
+                      {                                                                 \
+                          static CapacitySite *const site = capacity_site(location);    \
+                                                                                        \
+                          return CapacitySiteRef{site};                                 \
+                      }(CURRENT_LOCATION)
+
+void record_final_size(CapacitySite *site, size_t size);
+
+// 0 until the site has CAPACITY_HINT_MIN_SAMPLES samples.
+size_t capacity_hint(const CapacitySite *site);
+
+// Writes the learned hints as C++ constants, one per site, so they can be
+// compiled in as fixed reserve() values:
+//   const size_t RESERVE_HINT_<file stem>_<func>_<line> = <capacity>;          // <file>, <samples> samples
+void export_capacity_hints(std::ostream &stream);
+
+
+#endif
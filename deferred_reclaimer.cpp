@@ -0,0 +1,271 @@
+#include "deferred_reclaimer.hpp"
+
+#include <bit>
+#include <cmath>
+#include "background_worker.hpp"
+
+
+//---------------------------Deferred release--------------------------------------
+
+struct ReclaimJobRunner
+{
+    void consume(const ReclaimJob &job)
+    {
+        job.release_(job.data_, job.size_, job.capacity_);
+    }
+
+    void batch_done()
+    {}
+};
+
+using DeferredReclaimer = BackgroundWorker<ReclaimJob, DEFERRED_RELEASE_BACKLOG, ReclaimJobRunner>;
+
+static DeferredReclaimer *reclaimer()
+{
+    return process_instance<DeferredReclaimer>();
+}
+
+
+bool defer_release(const ReclaimJob &job)
+{
+    DeferredReclaimer *instance = reclaimer();
+
+    return (instance != nullptr) && (instance->submit(job) == SubmitResult::TAKEN);
+}
+
+void drain_deferred_releases()
+{
+    DeferredReclaimer *instance = reclaimer();
+    if (instance != nullptr)
+    {
+        instance->drain();
+    }
+}
+
+size_t deferred_backlog()
+{
+    DeferredReclaimer *instance = reclaimer();
+
+    return instance == nullptr ? 0 : instance->backlog();
+}
+
+void stop_deferred_reclaimer()
+{
+    DeferredReclaimer *instance = reclaimer();
+    if (instance != nullptr)
+    {
+        instance->stop();
+    }
+}
+
+
+//---------------------------Class LatencyHistogram--------------------------------
+
+void LatencyHistogram::record(uint64_t nanoseconds)
+{
+    ++buckets_[std::bit_width(nanoseconds)];
+    ++count_;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if (count_ == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t> (std::ceil(fraction * static_cast<double> (count_)));
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket)
+    {
+        seen += buckets_[bucket];
+        if (seen >= rank)
+        {
+            return bucket >= 64 ? UINT64_MAX : (static_cast<uint64_t> (1) << bucket);
+        }
+    }
+
+    return UINT64_MAX;
+}
+
+void LatencyHistogram::reset()
+{
+    for (size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket)
+    {
+        buckets_[bucket] = 0;
+    }
+
+    count_ = 0;
+}
+
+LatencyHistogram &release_latency_histogram()
+{
+    thread_local LatencyHistogram histogram;
+
+    return histogram;
+}
+
+
+//---------------------------Release latency benchmark-----------------------------
+// deferred_reclaimer.cpp is linked into every program that defers releases, so the
+// benchmark is only compiled with -DRECLAIMER_BENCHMARK. It checks that deferred
+// buffers and elements are freed on the reclaimer thread by the time drain returns,
+// then prints p50 / p99 of destroying vectors inline and in deferred mode.
+#ifdef RECLAIMER_BENCHMARK
+
+#define MEASURE_RELEASE_LATENCY
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+#include "vector.hpp"
+
+static std::atomic<size_t> live_allocations(0);
+
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    live_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return memory;
+}
+
+// All kept out of line: inlined into std::vector, malloc() and free() would be paired
+// with the builtin operators and trip -Wmismatched-new-delete.
+__attribute__((noinline)) void operator delete(void *memory) noexcept
+{
+    if (memory != nullptr)
+    {
+        live_allocations.fetch_sub(1, std::memory_order_relaxed);
+        std::free(memory);
+    }
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept
+{
+    operator delete(memory);
+}
+
+
+static const size_t BENCH_VECTOR_COUNT = 512;
+static const size_t BENCH_ROW_COUNT    = 1024;                                      // heap-owning elements per vector
+static const size_t BENCH_ROW_SIZE     = 16;
+
+static const size_t CHECK_VECTOR_COUNT  = 64;
+static const size_t CHECK_ELEMENT_COUNT = 100;
+
+static std::thread::id main_thread_id;
+static std::atomic<size_t> destroyed_on_reclaimer(0);
+static std::atomic<size_t> destroyed_on_main(0);
+
+class ThreadNoting
+{
+public:
+
+    ~ThreadNoting()
+    {
+        if (std::this_thread::get_id() == main_thread_id)
+        {
+            destroyed_on_main.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            destroyed_on_reclaimer.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Every element has to be destroyed, and every buffer freed, by the reclaimer thread
+// once drain_deferred_releases() returns.
+static bool check_drain_releases()
+{
+    std::vector<Vector<ThreadNoting>> vectors(CHECK_VECTOR_COUNT);
+    for (Vector<ThreadNoting> &vector : vectors)
+    {
+        vector.resize(CHECK_ELEMENT_COUNT);
+        vector.set_deferred_release(true);                                          // after the move into place: moves drop options
+    }
+
+    destroyed_on_main.store(0);
+    destroyed_on_reclaimer.store(0);
+    size_t live_before = live_allocations.load();
+
+    for (Vector<ThreadNoting> &vector : vectors)
+    {
+        vector.reset();
+    }
+
+    drain_deferred_releases();
+
+    size_t left_allocated = live_before - live_allocations.load();
+    size_t destroyed      = destroyed_on_reclaimer.load();
+
+    if ((destroyed != CHECK_VECTOR_COUNT * CHECK_ELEMENT_COUNT) || (destroyed_on_main.load() != 0) || (left_allocated != CHECK_VECTOR_COUNT))
+    {
+        std::cerr << "ERROR: after drain " << destroyed << " of " << CHECK_VECTOR_COUNT * CHECK_ELEMENT_COUNT
+                  << " elements were destroyed by the reclaimer, " << destroyed_on_main.load() << " inline, and "
+                  << left_allocated << " of " << CHECK_VECTOR_COUNT << " buffers were freed" << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+// Builds the vectors first and times only their destruction on this thread.
+static LatencyHistogram measure_release(bool deferred)
+{
+    std::vector<Vector<std::vector<int>>> vectors(BENCH_VECTOR_COUNT);
+    for (Vector<std::vector<int>> &vector : vectors)
+    {
+        vector.reserve(BENCH_ROW_COUNT);
+        for (size_t row = 0; row < BENCH_ROW_COUNT; ++row)
+        {
+            vector.push_back(std::vector<int>(BENCH_ROW_SIZE, 1));
+        }
+
+        vector.set_deferred_release(deferred);
+    }
+
+    release_latency_histogram().reset();
+    while (!vectors.empty())
+    {
+        vectors.pop_back();
+    }
+
+    LatencyHistogram latency = release_latency_histogram();
+    drain_deferred_releases();
+
+    return latency;
+}
+
+
+int main()
+{
+    main_thread_id = std::this_thread::get_id();
+
+    LatencyHistogram inline_latency   = measure_release(false);
+    LatencyHistogram deferred_latency = measure_release(true);
+
+    std::cout << BENCH_VECTOR_COUNT << " vectors of " << BENCH_ROW_COUNT << " std::vector<int>(" << BENCH_ROW_SIZE
+              << ") destroyed on the calling thread, ns (bucket upper bounds):" << std::endl
+              << "inline:   p50 " << inline_latency.percentile(0.5) << ", p99 " << inline_latency.percentile(0.99) << std::endl
+              << "deferred: p50 " << deferred_latency.percentile(0.5) << ", p99 " << deferred_latency.percentile(0.99) << std::endl;
+
+    return check_drain_releases() ? 0 : EXIT_FAILURE;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef DEFERRED_RECLAIMER_HPP
+#define DEFERRED_RECLAIMER_HPP
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+
+//---------------------------Deferred release--------------------------------------
+// A background thread that destroys elements and frees buffers handed over by
+// containers, so a latency-sensitive thread dropping a huge vector does not pay for it.
+// Jobs travel through a bounded lock-free queue: when it is full, defer_release()
+// refuses the job and the caller releases the buffer itself.
+
+const size_t DEFERRED_RELEASE_BACKLOG = 4096;
+
+struct ReclaimJob
+{
+    void  *data_     = nullptr;
+    size_t size_     = 0;                                                           // elements still to be destroyed
+    size_t capacity_ = 0;
+    void (*release_)(void *data, size_t size, size_t capacity) = nullptr;
+};
+
+
+// Returns false if the job was not taken (backlog is full or the reclaimer is stopped).
+bool defer_release(const ReclaimJob &job);
+
+// Blocks until every job deferred before the call has been released.
+void drain_deferred_releases();
+
+size_t deferred_backlog();
+
+// Drains the queue and joins the thread. Later jobs are released by their callers.
+void stop_deferred_reclaimer();
+
+
+//---------------------------Release latency---------------------------------------
+// Log2 buckets of nanoseconds: bucket b holds samples in [2^(b - 1), 2^b).
+const size_t LATENCY_BUCKETS = 65;
+
+class LatencyHistogram
+{
+public:
+
+    void record(uint64_t nanoseconds);
+
+    // Upper bound of the bucket holding the requested fraction of samples (0.99 for p99).
+    uint64_t percentile(double fraction) const;
+
+    uint64_t count() const
+    {
+        return count_;
+    }
+
+    void reset();
+
+private:
+
+    uint64_t buckets_[LATENCY_BUCKETS] = {};
+    uint64_t count_ = 0;
+};
+
+// Histogram of release times (destruction, shrinking, reallocation) on the calling thread.
+LatencyHistogram &release_latency_histogram();
+
+
+class ReleaseTimer
+{
+public:
+
+    ReleaseTimer()
+      : start_(std::chrono::steady_clock::now())
+    {}
+
+    ~ReleaseTimer()
+    {
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start_;
+
+        release_latency_histogram().record(static_cast<uint64_t> (elapsed.count()));
+    }
+
+private:
+
+    std::chrono::steady_clock::time_point start_;
+};
+
+
+#endif
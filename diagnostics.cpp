@@ -0,0 +1,177 @@
+#include "diagnostics.hpp"
+
+#include <atomic>
+#include <iostream>
+#include "background_worker.hpp"
+
+
+//---------------------------Event descriptions------------------------------------
+
+struct DiagCodeInfo
+{
+    const char *message_;
+    const char *fields_[DIAG_FIELD_COUNT];
+};
+
+static const DiagCodeInfo DIAG_CODE_INFO[] =
+{
+    {"location",                                         {}},
+    {"vector data was not allocated",                    {"capacity"}},
+    {"allocating more memory failed",                    {"capacity"}},
+    {"reserving memory failed",                          {"capacity"}},
+    {"shrink_to_fit failed",                             {"size", "capacity"}},
+    {"resizing failed",                                  {"size", "new size"}},
+    {"sequental initialization failed",                  {"from", "to"}},
+    {"attempt to get value out of bounds",               {"index", "size"}},
+    {"attempt to insert out of bounds",                  {"index", "size"}},
+    {"insertion failed",                                 {"index", "size"}},
+    {"attempt to erase out of bounds",                   {"index", "size"}},
+    {"erase failed",                                     {"index", "size"}},
+    {"push_back failed",                                 {"size"}},
+    {"bitwise operation on vectors of different sizes",  {"size", "other size"}},
+    {"erase",                                            {"index", "size"}},
+    {"attempt to get value by missing key",              {"size"}},
+    {"subview out of bounds",                            {"dim", "from", "to"}},
+    {"storage is too small for the tensor",              {"size", "required size"}},
+    {"copying between tensors of different shapes",      {"dim", "extent", "other extent"}},
+    {"attempt to get row out of bounds",                 {"row", "rows"}},
+    {"attempt to group into a missing row",              {"row", "rows"}},
+    {"attempt to append to a missing row",               {}},
+};
+
+static_assert(sizeof(DIAG_CODE_INFO) / sizeof(DIAG_CODE_INFO[0]) == static_cast<size_t> (DiagCode::CODE_COUNT),
+              "every DiagCode needs a description");
+
+
+void format_event(std::ostream &stream, const DiagEvent &event)
+{
+    const DiagCodeInfo &info = DIAG_CODE_INFO[static_cast<size_t> (event.code_)];
+
+    stream << (event.code_ == DiagCode::LOCATION || event.code_ == DiagCode::ERASE_TRACE ? "TRACE: " : "ERROR: ")
+           << info.message_;
+
+    for (size_t field = 0; (field < DIAG_FIELD_COUNT) && (info.fields_[field] != nullptr); ++field)
+    {
+        stream << (field == 0 ? " (" : ", ") << info.fields_[field] << " = " << event.fields_[field];
+        if ((field + 1 == DIAG_FIELD_COUNT) || (info.fields_[field + 1] == nullptr))
+        {
+            stream << ")";
+        }
+    }
+
+    stream << " at " << event.location_.file_ << ":" << event.location_.line_
+           << " in " << event.location_.func_ << "\n";
+}
+
+
+//---------------------------Class AsyncDiagnosticsSink----------------------------
+// Producers only push into the queue; formatting and the stream lock stay on the
+// worker thread. A full queue drops the event instead of waiting.
+
+struct EventWriter
+{
+    void consume(const DiagEvent &event)
+    {
+        format_event(std::cerr, event);
+    }
+
+    void batch_done()
+    {
+        std::cerr.flush();
+    }
+};
+
+class AsyncDiagnosticsSink : public DiagnosticsSink
+{
+public:
+
+    void record(const DiagEvent &event) override
+    {
+        switch (worker_.submit(event))
+        {
+            case SubmitResult::TAKEN:
+                break;
+
+            case SubmitResult::FULL:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                break;
+
+            case SubmitResult::STOPPED:
+                format_event(std::cerr, event);
+                break;
+        }
+    }
+
+    void flush()
+    {
+        worker_.drain();
+    }
+
+    size_t dropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    void stop()
+    {
+        worker_.stop();
+    }
+
+private:
+
+    std::atomic<size_t> dropped_{0};
+
+    BackgroundWorker<DiagEvent, DIAGNOSTICS_BACKLOG, EventWriter> worker_;
+};
+
+
+// Constant-initialized, so it stays valid while other static objects are being destroyed.
+static std::atomic<DiagnosticsSink *> current_sink{nullptr};
+
+static AsyncDiagnosticsSink *default_sink()
+{
+    return process_instance<AsyncDiagnosticsSink>();
+}
+
+
+DiagnosticsSink *set_diagnostics_sink(DiagnosticsSink *sink)
+{
+    return current_sink.exchange(sink, std::memory_order_acq_rel);
+}
+
+void report_event(const Location &location, DiagCode code, uint64_t first, uint64_t second, uint64_t third)
+{
+    DiagEvent event = {location, code, {first, second, third}};
+
+    DiagnosticsSink *sink = current_sink.load(std::memory_order_acquire);
+    if (sink == nullptr)
+    {
+        sink = default_sink();
+    }
+
+    // Nobody is left to consume events during static destruction, so write them directly.
+    if (sink == nullptr)
+    {
+        format_event(std::cerr, event);
+
+        return;
+    }
+
+    sink->record(event);
+}
+
+void flush_diagnostics()
+{
+    AsyncDiagnosticsSink *sink = default_sink();
+    if (sink != nullptr)
+    {
+        sink->flush();
+    }
+}
+
+size_t dropped_diagnostics()
+{
+    AsyncDiagnosticsSink *sink = default_sink();
+
+    return sink == nullptr ? 0 : sink->dropped();
+}
\ No newline at end of file
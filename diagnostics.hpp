@@ -0,0 +1,121 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <type_traits>
+#include "location.hpp"
+
+
+//---------------------------Defines section---------------------------------------
+//#define NULL_DIAGNOSTICS                                                          // drop every event at compile time
+//#define TRACE_DIAGNOSTICS                                                         // also report traces of ordinary operations
+
+
+// Events are only recorded at run time: inside a constant evaluation the
+// exception that follows is the diagnostic. Both macros are single statements
+// and are written with a trailing semicolon.
+#ifdef NULL_DIAGNOSTICS
+#define REPORT_EVENT(...) do {} while (0)
+#else
+#define REPORT_EVENT(...) do                                                        \
+                          {                                                         \
+                              if (!std::is_constant_evaluated())                    \
+                              {                                                     \
+                                  report_event(CURRENT_LOCATION, __VA_ARGS__);      \
+                              }                                                     \
+                          } while (0)
+#endif
+
+#if defined(TRACE_DIAGNOSTICS) && !defined(NULL_DIAGNOSTICS)
+#define REPORT_TRACE(...) REPORT_EVENT(__VA_ARGS__)
+#else
+#define REPORT_TRACE(...) do {} while (0)
+#endif
+
+
+//---------------------------Events------------------------------------------------
+// An event is only a code and a few numbers: it is copied into a lock-free queue
+// by the thread that hit it and turned into text later by the consumer thread.
+
+enum class DiagCode : uint16_t
+{
+    LOCATION,
+    NOT_ALLOCATED,
+    ALLOCATION_FAILED,
+    RESERVE_FAILED,
+    SHRINK_FAILED,
+    RESIZE_FAILED,
+    INIT_FAILED,
+    GET_OUT_OF_BOUNDS,
+    INSERT_OUT_OF_BOUNDS,
+    INSERT_FAILED,
+    ERASE_OUT_OF_BOUNDS,
+    ERASE_FAILED,
+    PUSH_BACK_FAILED,
+    SIZE_MISMATCH,
+    ERASE_TRACE,
+    MISSING_KEY,
+    SUBVIEW_OUT_OF_BOUNDS,
+    STORAGE_TOO_SMALL,
+    SHAPE_MISMATCH,
+    ROW_OUT_OF_BOUNDS,
+    GROUP_INTO_MISSING_ROW,
+    APPEND_TO_MISSING_ROW,
+
+    CODE_COUNT
+};
+
+const size_t DIAG_FIELD_COUNT    = 3;
+const size_t DIAGNOSTICS_BACKLOG = 1024;
+
+struct DiagEvent
+{
+    Location location_;
+    DiagCode code_ = DiagCode::LOCATION;
+
+    uint64_t fields_[DIAG_FIELD_COUNT] = {};
+};
+
+
+//---------------------------Sinks-------------------------------------------------
+
+class DiagnosticsSink
+{
+public:
+
+    virtual ~DiagnosticsSink() = default;
+
+    // Called by the thread that hit the event, so it must not block.
+    virtual void record(const DiagEvent &event) = 0;
+};
+
+// Discards events at run time. To drop them at compile time define NULL_DIAGNOSTICS.
+class NullDiagnosticsSink : public DiagnosticsSink
+{
+public:
+
+    void record(const DiagEvent &) override
+    {}
+};
+
+
+// Passing nullptr restores the default sink: a bounded lock-free queue drained by a
+// background thread that writes events to std::cerr. Returns the previous sink.
+DiagnosticsSink *set_diagnostics_sink(DiagnosticsSink *sink);
+
+void report_event(const Location &location, DiagCode code, uint64_t first = 0, uint64_t second = 0, uint64_t third = 0);
+
+// "ERROR: <message> (<field> = <value>, ...) at <file>:<line> in <func>"
+void format_event(std::ostream &stream, const DiagEvent &event);
+
+// Blocks until the default sink has written every event reported before the call.
+void flush_diagnostics();
+
+// Events the default sink lost because its queue was full.
+size_t dropped_diagnostics();
+
+
+#endif
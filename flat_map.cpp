@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+#include "flat_map.hpp"
+
+
+//---------------------------Lookup benchmark--------------------------------------
+// Looks up random keys (half of them present) in FlatMap with both layouts and in
+// std::map of the same size and prints millions of lookups per second. The values
+// found are summed, and every container must give the same sum.
+
+const size_t BENCH_LOOKUP_COUNT = 1 << 21;
+const size_t BENCH_MAP_SIZES[]  = {64, 1024, 16384, 262144, 1 << 20};
+
+static const uint64_t *find_value(const FlatMap<uint32_t, uint64_t> &map, uint32_t key)
+{
+    return map.get(key);
+}
+
+static const uint64_t *find_value(const std::map<uint32_t, uint64_t> &map, uint32_t key)
+{
+    auto found = map.find(key);
+
+    return found == map.end() ? nullptr : &found->second;
+}
+
+template <class Map>
+static double measure_lookups(const Map &map, const std::vector<uint32_t> &queries, uint64_t &sum)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    sum = 0;
+    for (uint32_t query : queries)
+    {
+        const uint64_t *value = find_value(map, query);
+        sum += value == nullptr ? 0 : *value;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return static_cast<double> (queries.size()) / elapsed.count() / 1e6;
+}
+
+static bool bench_lookups(size_t map_size, std::mt19937 &generator)
+{
+    std::vector<uint32_t> keys(map_size);
+    for (uint32_t &key : keys)
+    {
+        key = static_cast<uint32_t> (generator()) & ~static_cast<uint32_t> (1);     // present keys are even
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<uint64_t> values(keys.size());
+    for (size_t index = 0; index < keys.size(); ++index)
+    {
+        values[index] = static_cast<uint64_t> (keys[index]) * 3 + 1;
+    }
+
+    std::vector<uint32_t> queries(BENCH_LOOKUP_COUNT);
+    for (uint32_t &query : queries)
+    {
+        query = keys[generator() % keys.size()] | static_cast<uint32_t> (generator() % 2);
+    }
+
+    FlatMap<uint32_t, uint64_t> sorted(FlatLayout::SORTED);
+    sorted.insert_sorted(keys, values);
+
+    FlatMap<uint32_t, uint64_t> eytzinger(FlatLayout::EYTZINGER);
+    eytzinger.insert_sorted(keys, values);
+
+    std::map<uint32_t, uint64_t> tree;
+    for (size_t index = 0; index < keys.size(); ++index)
+    {
+        tree.emplace_hint(tree.end(), keys[index], values[index]);
+    }
+
+    uint64_t sorted_sum    = 0;
+    uint64_t eytzinger_sum = 0;
+    uint64_t tree_sum      = 0;
+
+    double sorted_rate    = measure_lookups(sorted, queries, sorted_sum);
+    double eytzinger_rate = measure_lookups(eytzinger, queries, eytzinger_sum);
+    double tree_rate      = measure_lookups(tree, queries, tree_sum);
+
+    std::cout << std::fixed << std::setprecision(1) << "size " << keys.size() << ": sorted " << sorted_rate
+              << ", eytzinger " << eytzinger_rate << ", std::map " << tree_rate << " Mlookups/s" << std::endl;
+
+    if ((sorted_sum != tree_sum) || (eytzinger_sum != tree_sum))
+    {
+        std::cerr << "ERROR: FlatMap found values summing to " << sorted_sum << " (sorted) and " << eytzinger_sum
+                  << " (eytzinger), std::map to " << tree_sum << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    std::mt19937 generator(1);
+
+    bool passed = true;
+    for (size_t map_size : BENCH_MAP_SIZES)
+    {
+        passed = bench_lookups(map_size, generator) && passed;
+    }
+
+    return passed ? 0 : EXIT_FAILURE;
+}
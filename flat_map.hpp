@@ -0,0 +1,308 @@
+#ifndef FLAT_MAP_HPP
+#define FLAT_MAP_HPP
+
+
+#include "flat_set.hpp"
+
+
+//---------------------------Class FlatMap-----------------------------------------
+// Keys and values live in separate vectors, so lookups only touch the keys.
+template <class Key, class Value>
+class FlatMap
+{
+public:
+//--------------------Constructors, destructors and =------------------------------
+    FlatMap(FlatLayout layout = FlatLayout::SORTED)
+      : layout_(layout)
+    {
+        rebuild_layout();                                                           // lookups read node 0 even when empty
+    }
+
+//---------------------------Size and capacity-------------------------------------
+
+    bool empty() const
+    {
+        return keys_.empty();
+    }
+
+    size_t size() const
+    {
+        return keys_.size();
+    }
+
+    void reserve(size_t reserved_size)
+    {
+        keys_.reserve(reserved_size);
+        values_.reserve(reserved_size);
+    }
+
+    FlatLayout layout() const
+    {
+        return layout_;
+    }
+
+    void set_layout(FlatLayout layout)
+    {
+        layout_ = layout;
+
+        rebuild_layout();
+    }
+
+//---------------------------Lookup------------------------------------------------
+
+    size_t lower_bound(const Key &key) const
+    {
+        if (layout_ == FlatLayout::EYTZINGER)
+        {
+            return eytzinger_lower_bound(eytzinger_blocks_.data(), size(), key);
+        }
+
+        return flat_lower_bound(keys_.data(), size(), key);
+    }
+
+    // Returns index of key or size() if there is no such key.
+    size_t find(const Key &key) const
+    {
+        if (layout_ == FlatLayout::EYTZINGER)
+        {
+            return eytzinger_find(eytzinger_blocks_.data(), size(), key);
+        }
+
+        size_t index = lower_bound(key);
+        if ((index < size()) && (!(key < keys_[index])))
+        {
+            return index;
+        }
+
+        return size();
+    }
+
+    bool contains(const Key &key) const
+    {
+        return find(key) != size();
+    }
+
+    size_t count(const Key &key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    const Value *get(const Key &key) const
+    {
+        return const_cast<FlatMap *> (this)->get(key);
+    }
+
+    Value *get(const Key &key)
+    {
+        size_t index = find(key);
+
+        return index == size() ? nullptr : &values_[index];
+    }
+
+    const Value &at(const Key &key) const
+    {
+        return const_cast<const Value &> (const_cast<FlatMap *> (this)->at(key));
+    }
+
+    Value &at(const Key &key)
+    {
+        Value *value = get(key);
+        if (value != nullptr)
+        {
+            return *value;
+        }
+
+        REPORT_EVENT(DiagCode::MISSING_KEY, size());
+
+        throw std::out_of_range("ERROR: attempt to get value by missing key");
+    }
+
+    Value &operator [](const Key &key)
+    {
+        size_t index = flat_lower_bound(keys_.data(), size(), key);
+        if ((index == size()) || (key < keys_[index]))
+        {
+            insert_at(index, key, Value());
+        }
+
+        return values_[index];
+    }
+
+    const Key &key_at(const size_t index) const
+    {
+        return keys_[index];
+    }
+
+    const Value &value_at(const size_t index) const
+    {
+        return values_[index];
+    }
+
+    Value &value_at(const size_t index)
+    {
+        return values_[index];
+    }
+
+//---------------------------Modifiers---------------------------------------------
+
+    bool insert(const Key &key, const Value &value)
+    {
+        size_t index = flat_lower_bound(keys_.data(), size(), key);
+        if ((index < size()) && (!(key < keys_[index])))
+        {
+            return false;
+        }
+
+        insert_at(index, key, value);
+
+        return true;
+    }
+
+    bool erase(const Key &key)
+    {
+        size_t index = find(key);
+        if (index == size())
+        {
+            return false;
+        }
+
+        keys_.erase(index);
+        values_.erase(index);
+
+        rebuild_layout();
+
+        return true;
+    }
+
+    void clear()
+    {
+        keys_.clear();
+        values_.clear();
+
+        rebuild_layout();
+    }
+
+    // Merges sorted keys [keys_first, keys_last) with values starting at values_first in one pass.
+    // Existing keys keep their values, duplicates inside the range keep the first one.
+    template <class KeyIterator, class ValueIterator>
+    void insert_sorted(KeyIterator keys_first, KeyIterator keys_last, ValueIterator values_first)
+    {
+        size_t merged_size = 0;
+        merge_sorted(keys_first, keys_last, values_first, [&merged_size](const Key &, const Value &){ ++merged_size; });
+
+        if (merged_size == size())
+        {
+            return;
+        }
+
+        Vector<Key>   merged_keys  (merged_size);
+        Vector<Value> merged_values(merged_size);
+        size_t merged_index = 0;
+        merge_sorted(keys_first, keys_last, values_first,
+                     [&merged_keys, &merged_values, &merged_index](const Key &key, const Value &value)
+                     {
+                         merged_keys  [merged_index] = key;
+                         merged_values[merged_index] = value;
+                         ++merged_index;
+                     });
+
+        keys_.swap(merged_keys);
+        values_.swap(merged_values);
+
+        rebuild_layout();
+    }
+
+    template <class KeyRange, class ValueRange>
+    void insert_sorted(const KeyRange &keys, const ValueRange &values)
+    {
+        insert_sorted(std::begin(keys), std::end(keys), std::begin(values));
+    }
+
+    void swap(FlatMap &other)
+    {
+        keys_.swap(other.keys_);
+        values_.swap(other.values_);
+        eytzinger_blocks_.swap(other.eytzinger_blocks_);
+        std::swap(layout_, other.layout_);
+    }
+
+private:
+//--------------------------Utility functions--------------------------------------
+
+    void insert_at(size_t index, const Key &key, const Value &value)
+    {
+        keys_.insert(index, key);
+        try
+        {
+            values_.insert(index, value);
+        }
+        catch (...)
+        {
+            keys_.erase(index);
+
+            throw;
+        }
+
+        rebuild_layout();
+    }
+
+    template <class KeyIterator, class ValueIterator, class Output>
+    void merge_sorted(KeyIterator keys_first, KeyIterator keys_last, ValueIterator values_first, Output output) const
+    {
+        size_t index = 0;
+        const Key *previous = nullptr;
+
+        while ((index < size()) || (keys_first != keys_last))
+        {
+            const Key   *next_key   = nullptr;
+            const Value *next_value = nullptr;
+            if ((keys_first == keys_last) || ((index < size()) && (!(*keys_first < keys_[index]))))
+            {
+                next_key   = &keys_[index];
+                next_value = &values_[index];
+                ++index;
+            }
+            else
+            {
+                next_key   = &*keys_first;
+                next_value = &*values_first;
+                ++keys_first;
+                ++values_first;
+            }
+
+            if ((previous == nullptr) || (*previous < *next_key))
+            {
+                output(*next_key, *next_value);
+                previous = next_key;
+            }
+        }
+    }
+
+    // Single inserts and erases shift keys_ in O(n) anyway; in EYTZINGER mode they
+    // also rebuild the whole layout (in the same buffer when it is big enough), so
+    // bulk loads should use insert_sorted() or run in SORTED mode before set_layout().
+    void rebuild_layout()
+    {
+        if (layout_ != FlatLayout::EYTZINGER)
+        {
+            eytzinger_blocks_.clear();
+
+            return;
+        }
+
+        eytzinger_blocks_.resize(eytzinger_block_count<Key>(size()));
+        build_eytzinger(keys_.data(), size(), eytzinger_blocks_.data());
+    }
+
+private:
+//----------------------------Variables--------------------------------------------
+
+    Vector<Key>                 keys_;
+    Vector<Value>               values_;
+    Vector<EytzingerBlock<Key>> eytzinger_blocks_;
+
+    FlatLayout layout_ = FlatLayout::SORTED;
+};
+
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef FLAT_SEARCH_HPP
+#define FLAT_SEARCH_HPP
+
+
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+
+//---------------------------Const section-----------------------------------------
+const size_t FLAT_SEARCH_LINEAR_BLOCK = 16;                                         // integer tails shorter than this are counted, not bisected
+const size_t CACHE_LINE_SIZE          = 64;
+
+
+//---------------------------Sorted layout-----------------------------------------
+// Returns index of the first element that is not less than key (size if there is none).
+// The loop body has no data-dependent branches: the comparison only selects the next base.
+template <class Key>
+size_t branchless_lower_bound(const Key *data, size_t size, const Key &key)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    const Key *base = data;
+    while (size > 1)
+    {
+        size_t half = size / 2;
+        base  = (base[half] < key) ? base + half : base;
+        size -= half;
+    }
+
+    return static_cast<size_t> (base - data) + (*base < key);
+}
+
+// Same as branchless_lower_bound, but stops bisecting once FLAT_SEARCH_LINEAR_BLOCK
+// elements are left and counts the smaller ones with a loop the compiler turns into SIMD compares.
+template <class Key>
+size_t simd_lower_bound(const Key *data, size_t size, const Key &key)
+{
+    static_assert(std::is_integral<Key>::value, "simd_lower_bound requires integer keys");
+
+    const Key *base = data;
+    while (size > FLAT_SEARCH_LINEAR_BLOCK)
+    {
+        size_t half = size / 2;
+        base  = (base[half] < key) ? base + half : base;
+        size -= half;
+    }
+
+    size_t less_count = 0;
+    for (size_t index = 0; index < size; ++index)
+    {
+        less_count += (base[index] < key);
+    }
+
+    return static_cast<size_t> (base - data) + less_count;
+}
+
+template <class Key>
+size_t flat_lower_bound(const Key *data, size_t size, const Key &key)
+{
+    if constexpr (std::is_integral<Key>::value)
+    {
+        return simd_lower_bound(data, size, key);
+    }
+    else
+    {
+        return branchless_lower_bound(data, size, key);
+    }
+}
+
+
+//---------------------------Eytzinger layout--------------------------------------
+// Eytzinger arrays are 1-based: node k has children 2k and 2k + 1, slot 0 is unused.
+// Nodes are stored in cache-line aligned blocks of KEYS, a power of two, so the
+// descendants of node k log2(KEYS) levels down (nodes k * KEYS ... k * KEYS + KEYS - 1)
+// are exactly block k and one prefetch brings them all in.
+template <class Key>
+struct alignas(CACHE_LINE_SIZE) EytzingerBlock
+{
+    static const size_t KEYS = std::bit_floor(sizeof(Key) < CACHE_LINE_SIZE ? CACHE_LINE_SIZE / sizeof(Key) : 1);
+
+    Key keys_[KEYS];
+};
+
+template <class Key>
+constexpr size_t eytzinger_block_count(size_t size)
+{
+    return size / EytzingerBlock<Key>::KEYS + 1;                                    // nodes 0 ... size
+}
+
+// When blocks have no padding node k is simply the k-th key of the storage, which
+// keeps the address one multiply-add away from node on the lookup's critical path.
+template <class Key>
+const Key &eytzinger_node(const EytzingerBlock<Key> *blocks, size_t node)
+{
+    if constexpr (EytzingerBlock<Key>::KEYS * sizeof(Key) == sizeof(EytzingerBlock<Key>))
+    {
+        return *reinterpret_cast<const Key *> (reinterpret_cast<const char *> (blocks) + node * sizeof(Key));
+    }
+    else
+    {
+        return blocks[node / EytzingerBlock<Key>::KEYS].keys_[node % EytzingerBlock<Key>::KEYS];
+    }
+}
+
+template <class Key>
+Key &eytzinger_node(EytzingerBlock<Key> *blocks, size_t node)
+{
+    return const_cast<Key &> (eytzinger_node(const_cast<const EytzingerBlock<Key> *> (blocks), node));
+}
+
+template <class Key>
+size_t build_eytzinger(const Key *sorted, size_t size, EytzingerBlock<Key> *blocks, size_t sorted_index = 0, size_t node = 1)
+{
+    if (node <= size)
+    {
+        sorted_index = build_eytzinger(sorted, size, blocks, sorted_index, 2 * node);
+
+        eytzinger_node(blocks, node) = sorted[sorted_index];
+        ++sorted_index;
+
+        sorted_index = build_eytzinger(sorted, size, blocks, sorted_index, 2 * node + 1);
+    }
+
+    return sorted_index;
+}
+
+// Position of node in the sorted order, computed instead of stored so a lookup does
+// not pay one more cache miss. In the perfect tree of the same height node k on
+// depth d is at (2 * (k - 2^d) + 1) * 2^(height - 1 - d) - 1; the last level is only
+// filled from the left, so the missing last-level slots before it are subtracted.
+constexpr size_t eytzinger_rank(size_t node, size_t size)
+{
+    size_t height = static_cast<size_t> (std::bit_width(size));
+    size_t depth  = static_cast<size_t> (std::bit_width(node)) - 1;
+
+    size_t full_rank = ((2 * node - (static_cast<size_t> (2) << depth) + 1) << (height - 1 - depth)) - 1;
+
+    size_t last_level_filled = size - ((static_cast<size_t> (1) << (height - 1)) - 1);
+    size_t last_level_before = (full_rank + 1) / 2;                                 // last level takes the even positions
+
+    return last_level_before > last_level_filled ? full_rank - (last_level_before - last_level_filled) : full_rank;
+}
+
+// Returns the node of the first element that is not less than key (0 if there is none).
+template <class Key>
+size_t eytzinger_lower_bound_node(const EytzingerBlock<Key> *blocks, size_t size, const Key &key)
+{
+    size_t node   = 1;
+    size_t levels = static_cast<size_t> (std::bit_width(size));                     // all but the last one are full
+
+    for (size_t level = 1; level < levels; ++level)                                 // a fixed trip count, so the exit is predicted
+    {
+        __builtin_prefetch(blocks + node);                                          // log2(KEYS) levels down
+
+        node = 2 * node + (eytzinger_node(blocks, node) < key);
+    }
+
+    // The last level is filled from the left only, so the last step is taken under a
+    // mask: which nodes exist depends on the key, and a branch here mispredicts often.
+    size_t in_tree = static_cast<size_t> (0) - (node <= size);                      // all ones or zero
+    size_t child   = 2 * node + (eytzinger_node(blocks, node & in_tree) < key);      // slot 0 is readable
+    node += (child - node) & in_tree;
+
+    return node >> (std::countr_one(node) + 1);                                     // undo the right turns taken after the answer
+}
+
+// Returns sorted index of the first element that is not less than key (size if there is none).
+template <class Key>
+size_t eytzinger_lower_bound(const EytzingerBlock<Key> *blocks, size_t size, const Key &key)
+{
+    size_t node = eytzinger_lower_bound_node(blocks, size, key);
+
+    return node == 0 ? size : eytzinger_rank(node, size);
+}
+
+// Returns sorted index of key (size if there is none). The found key is compared
+// where the search left it, in a block already in cache, instead of in the sorted keys.
+template <class Key>
+size_t eytzinger_find(const EytzingerBlock<Key> *blocks, size_t size, const Key &key)
+{
+    size_t node  = eytzinger_lower_bound_node(blocks, size, key);
+    size_t found = static_cast<size_t> (0) - ((node != 0) & !(key < eytzinger_node(blocks, node)));
+
+    return (eytzinger_rank(node | (node == 0), size) & found) | (size & ~found);   // a hit is a coin flip, so no branch
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+#include "flat_set.hpp"
+
+
+//---------------------------Lookup benchmark--------------------------------------
+// Looks up random keys (half of them present) in FlatSet with both layouts and in
+// std::set of the same size and prints millions of lookups per second. Every
+// container must find the same number of keys, otherwise the program fails.
+
+const size_t BENCH_LOOKUP_COUNT = 1 << 21;
+const size_t BENCH_SET_SIZES[]  = {64, 1024, 16384, 262144, 1 << 20};
+
+template <class Set>
+static double measure_lookups(const Set &set, const std::vector<uint32_t> &queries, size_t &found)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    found = 0;
+    for (uint32_t query : queries)
+    {
+        found += set.contains(query) ? 1 : 0;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return static_cast<double> (queries.size()) / elapsed.count() / 1e6;
+}
+
+static bool bench_lookups(size_t set_size, std::mt19937 &generator)
+{
+    std::vector<uint32_t> keys(set_size);
+    for (uint32_t &key : keys)
+    {
+        key = static_cast<uint32_t> (generator()) & ~static_cast<uint32_t> (1);     // present keys are even
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<uint32_t> queries(BENCH_LOOKUP_COUNT);
+    for (uint32_t &query : queries)
+    {
+        query = keys[generator() % keys.size()] | static_cast<uint32_t> (generator() % 2);
+    }
+
+    FlatSet<uint32_t> sorted(FlatLayout::SORTED);
+    sorted.insert_sorted(keys);
+
+    FlatSet<uint32_t> eytzinger(FlatLayout::EYTZINGER);
+    eytzinger.insert_sorted(keys);
+
+    std::set<uint32_t> tree(keys.begin(), keys.end());
+
+    size_t sorted_found    = 0;
+    size_t eytzinger_found = 0;
+    size_t tree_found      = 0;
+
+    double sorted_rate    = measure_lookups(sorted, queries, sorted_found);
+    double eytzinger_rate = measure_lookups(eytzinger, queries, eytzinger_found);
+    double tree_rate      = measure_lookups(tree, queries, tree_found);
+
+    std::cout << std::fixed << std::setprecision(1) << "size " << keys.size() << ": sorted " << sorted_rate << ", eytzinger " << eytzinger_rate
+              << ", std::set " << tree_rate << " Mlookups/s" << std::endl;
+
+    if ((sorted_found != tree_found) || (eytzinger_found != tree_found))
+    {
+        std::cerr << "ERROR: FlatSet found " << sorted_found << " (sorted) and " << eytzinger_found
+                  << " (eytzinger) keys, std::set found " << tree_found << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    std::mt19937 generator(1);
+
+    bool passed = true;
+    for (size_t set_size : BENCH_SET_SIZES)
+    {
+        passed = bench_lookups(set_size, generator) && passed;
+    }
+
+    return passed ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,244 @@
+#ifndef FLAT_SET_HPP
+#define FLAT_SET_HPP
+
+
+#include <iterator>
+#include "flat_search.hpp"
+#include "vector.hpp"
+
+
+// EYTZINGER pays off once the keys outgrow the caches (about 256k 4-byte keys and
+// up here); below that SORTED's binary search is faster.
+enum class FlatLayout
+{
+    SORTED,
+    EYTZINGER
+};
+
+
+//---------------------------Class FlatSet-----------------------------------------
+template <class Key>
+class FlatSet
+{
+public:
+//--------------------Constructors, destructors and =------------------------------
+    FlatSet(FlatLayout layout = FlatLayout::SORTED)
+      : layout_(layout)
+    {
+        rebuild_layout();                                                           // lookups read node 0 even when empty
+    }
+
+//---------------------------Size and capacity-------------------------------------
+
+    bool empty() const
+    {
+        return keys_.empty();
+    }
+
+    size_t size() const
+    {
+        return keys_.size();
+    }
+
+    void reserve(size_t reserved_size)
+    {
+        keys_.reserve(reserved_size);
+    }
+
+    FlatLayout layout() const
+    {
+        return layout_;
+    }
+
+    void set_layout(FlatLayout layout)
+    {
+        layout_ = layout;
+
+        rebuild_layout();
+    }
+
+//---------------------------Lookup------------------------------------------------
+
+    size_t lower_bound(const Key &key) const
+    {
+        if (layout_ == FlatLayout::EYTZINGER)
+        {
+            return eytzinger_lower_bound(eytzinger_blocks_.data(), size(), key);
+        }
+
+        return flat_lower_bound(keys_.data(), size(), key);
+    }
+
+    // Returns index of key or size() if there is no such key.
+    size_t find(const Key &key) const
+    {
+        if (layout_ == FlatLayout::EYTZINGER)
+        {
+            return eytzinger_find(eytzinger_blocks_.data(), size(), key);
+        }
+
+        size_t index = lower_bound(key);
+        if ((index < size()) && (!(key < keys_[index])))
+        {
+            return index;
+        }
+
+        return size();
+    }
+
+    bool contains(const Key &key) const
+    {
+        return find(key) != size();
+    }
+
+    size_t count(const Key &key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    const Key &operator [](const size_t index) const
+    {
+        return keys_[index];
+    }
+
+    const Key *begin() const
+    {
+        return keys_.data();
+    }
+
+    const Key *end() const
+    {
+        return keys_.data() + keys_.size();
+    }
+
+//---------------------------Modifiers---------------------------------------------
+
+    bool insert(const Key &key)
+    {
+        size_t index = flat_lower_bound(keys_.data(), size(), key);
+        if ((index < size()) && (!(key < keys_[index])))
+        {
+            return false;
+        }
+
+        keys_.insert(index, key);
+
+        rebuild_layout();
+
+        return true;
+    }
+
+    bool erase(const Key &key)
+    {
+        size_t index = find(key);
+        if (index == size())
+        {
+            return false;
+        }
+
+        keys_.erase(index);
+
+        rebuild_layout();
+
+        return true;
+    }
+
+    void clear()
+    {
+        keys_.clear();
+
+        rebuild_layout();
+    }
+
+    // Merges an already sorted range in one pass instead of shifting the tail per element.
+    // Duplicates (inside the range and against the set) are dropped.
+    template <class Iterator>
+    void insert_sorted(Iterator first, Iterator last)
+    {
+        size_t merged_size = 0;
+        merge_sorted(first, last, [&merged_size](const Key &){ ++merged_size; });
+
+        if (merged_size == size())
+        {
+            return;
+        }
+
+        Vector<Key> merged(merged_size);
+        size_t merged_index = 0;
+        merge_sorted(first, last, [&merged, &merged_index](const Key &key){ merged[merged_index++] = key; });
+
+        keys_.swap(merged);
+
+        rebuild_layout();
+    }
+
+    template <class Range>
+    void insert_sorted(const Range &range)
+    {
+        insert_sorted(std::begin(range), std::end(range));
+    }
+
+    void swap(FlatSet &other)
+    {
+        keys_.swap(other.keys_);
+        eytzinger_blocks_.swap(other.eytzinger_blocks_);
+        std::swap(layout_, other.layout_);
+    }
+
+private:
+//--------------------------Utility functions--------------------------------------
+
+    template <class Iterator, class Output>
+    void merge_sorted(Iterator first, Iterator last, Output output) const
+    {
+        size_t index = 0;
+        const Key *previous = nullptr;
+
+        while ((index < size()) || (first != last))
+        {
+            const Key *next = nullptr;
+            if ((first == last) || ((index < size()) && (!(*first < keys_[index]))))
+            {
+                next = &keys_[index++];
+            }
+            else
+            {
+                next = &*first;
+                ++first;
+            }
+
+            if ((previous == nullptr) || (*previous < *next))
+            {
+                output(*next);
+                previous = next;
+            }
+        }
+    }
+
+    // Single inserts and erases shift keys_ in O(n) anyway; in EYTZINGER mode they
+    // also rebuild the whole layout (in the same buffer when it is big enough), so
+    // bulk loads should use insert_sorted() or run in SORTED mode before set_layout().
+    void rebuild_layout()
+    {
+        if (layout_ != FlatLayout::EYTZINGER)
+        {
+            eytzinger_blocks_.clear();
+
+            return;
+        }
+
+        eytzinger_blocks_.resize(eytzinger_block_count<Key>(size()));
+        build_eytzinger(keys_.data(), size(), eytzinger_blocks_.data());
+    }
+
+private:
+//----------------------------Variables--------------------------------------------
+
+    Vector<Key>                 keys_;
+    Vector<EytzingerBlock<Key>> eytzinger_blocks_;
+
+    FlatLayout layout_ = FlatLayout::SORTED;
+};
+
+
+#endif
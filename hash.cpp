@@ -0,0 +1,344 @@
+#include "hash.hpp"
+
+#include <bit>
+#include <cstring>
+
+
+//---------------------------XXH64 primitives--------------------------------------
+static const uint64_t PRIME_1 = 11400714785074694791ULL;
+static const uint64_t PRIME_2 = 14029467366897019727ULL;
+static const uint64_t PRIME_3 =  1609587929392839161ULL;
+static const uint64_t PRIME_4 =  9650029242287828579ULL;
+static const uint64_t PRIME_5 =  2870177450012600261ULL;
+
+
+static uint64_t read_u64(const unsigned char *bytes)
+{
+    uint64_t value = 0;
+    memcpy(&value, bytes, sizeof(value));
+
+    return value;
+}
+
+static uint32_t read_u32(const unsigned char *bytes)
+{
+    uint32_t value = 0;
+    memcpy(&value, bytes, sizeof(value));
+
+    return value;
+}
+
+static uint64_t round_lane(uint64_t lane, uint64_t input)
+{
+    lane += input * PRIME_2;
+    lane  = std::rotl(lane, 31);
+
+    return lane * PRIME_1;
+}
+
+static uint64_t merge_lane(uint64_t hash, uint64_t lane)
+{
+    hash ^= round_lane(0, lane);
+
+    return hash * PRIME_1 + PRIME_4;
+}
+
+static void init_lanes(uint64_t *lanes, uint64_t seed)
+{
+    lanes[0] = seed + PRIME_1 + PRIME_2;
+    lanes[1] = seed + PRIME_2;
+    lanes[2] = seed;
+    lanes[3] = seed - PRIME_1;
+}
+
+static void consume_stripe(uint64_t *lanes, const unsigned char *stripe)
+{
+    lanes[0] = round_lane(lanes[0], read_u64(stripe));
+    lanes[1] = round_lane(lanes[1], read_u64(stripe + 8));
+    lanes[2] = round_lane(lanes[2], read_u64(stripe + 16));
+    lanes[3] = round_lane(lanes[3], read_u64(stripe + 24));
+}
+
+static uint64_t fold_lanes(const uint64_t *lanes)
+{
+    uint64_t hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+
+    for (size_t lane = 0; lane < 4; ++lane)
+    {
+        hash = merge_lane(hash, lanes[lane]);
+    }
+
+    return hash;
+}
+
+// Mixes in the last (less than 32) bytes and avalanches the result.
+static uint64_t finalize(uint64_t hash, const unsigned char *tail, size_t length)
+{
+    for (; length >= 8; tail += 8, length -= 8)
+    {
+        hash ^= round_lane(0, read_u64(tail));
+        hash  = std::rotl(hash, 27) * PRIME_1 + PRIME_4;
+    }
+
+    if (length >= 4)
+    {
+        hash ^= static_cast<uint64_t> (read_u32(tail)) * PRIME_1;
+        hash  = std::rotl(hash, 23) * PRIME_2 + PRIME_3;
+
+        tail   += 4;
+        length -= 4;
+    }
+
+    for (; length > 0; ++tail, --length)
+    {
+        hash ^= (*tail) * PRIME_5;
+        hash  = std::rotl(hash, 11) * PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+
+//---------------------------One-shot hashing--------------------------------------
+
+uint64_t hash_bytes(const void *data, size_t length, uint64_t seed)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *> (data);
+    const size_t total_length  = length;
+
+    uint64_t hash = 0;
+    if (length >= 32)
+    {
+        uint64_t lanes[4] = {};
+        init_lanes(lanes, seed);
+
+        for (; length >= 32; bytes += 32, length -= 32)
+        {
+            consume_stripe(lanes, bytes);
+        }
+
+        hash = fold_lanes(lanes);
+    }
+    else
+    {
+        hash = seed + PRIME_5;
+    }
+
+    hash += total_length;
+
+    return finalize(hash, bytes, length);
+}
+
+
+//---------------------------Class IncrementalHash---------------------------------
+
+IncrementalHash::IncrementalHash(uint64_t seed)
+  : seed_(seed)
+{
+    init_lanes(lanes_, seed);
+}
+
+void IncrementalHash::update(const void *data, size_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    const unsigned char *bytes = static_cast<const unsigned char *> (data);
+    total_length_ += length;
+
+    if (buffered_ + length < STRIPE_SIZE)
+    {
+        memcpy(buffer_ + buffered_, bytes, length);
+        buffered_ += length;
+
+        return;
+    }
+
+    if (buffered_ != 0)
+    {
+        size_t missing = STRIPE_SIZE - buffered_;
+        memcpy(buffer_ + buffered_, bytes, missing);
+        consume_stripe(lanes_, buffer_);
+
+        bytes    += missing;
+        length   -= missing;
+        buffered_ = 0;
+    }
+
+    for (; length >= STRIPE_SIZE; bytes += STRIPE_SIZE, length -= STRIPE_SIZE)
+    {
+        consume_stripe(lanes_, bytes);
+    }
+
+    memcpy(buffer_, bytes, length);
+    buffered_ = length;
+}
+
+uint64_t IncrementalHash::digest() const
+{
+    uint64_t hash = total_length_ >= STRIPE_SIZE ? fold_lanes(lanes_) : seed_ + PRIME_5;
+
+    hash += total_length_;
+
+    return finalize(hash, buffer_, buffered_);
+}
+
+
+//---------------------------Throughput benchmark----------------------------------
+// hash.cpp is linked into every program that hashes, so the benchmark is only
+// compiled with -DHASH_BENCHMARK. It prints GB/s of hash_bytes and of std::hash
+// for std::string_view over keys of several lengths, and checks hash_bytes against
+// XXH64 reference values and against IncrementalHash fed in uneven pieces.
+#ifdef HASH_BENCHMARK
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+static const size_t BENCH_BUFFER_SIZE   = 1 << 24;
+static const size_t BENCH_BYTE_BUDGET   = 1 << 30;                                  // bytes hashed per measurement
+static const size_t BENCH_KEY_LENGTHS[] = {8, 32, 256, 4096, 1 << 16, 1 << 24};
+
+// Reference XXH64 values, seed 0. Inputs of 32 bytes or more go through the stripe
+// loop and end in different tails: 39 = stripe + 4 + 3 bytes, 43 = stripe + 8 + 3.
+struct ReferenceHash
+{
+    std::string_view input;
+    uint64_t hash;
+};
+
+static const ReferenceHash XXH64_REFERENCES[] =
+{
+    {"",                                            0xEF46DB3751D8E999ULL},
+    {"a",                                           0xD24EC4F1A98C6E5BULL},
+    {"abc",                                         0x44BC2CF5AD770999ULL},
+    {"Nobody inspects the spammish repetition",     0xFBCEA83C8A378BF1ULL},
+    {"The quick brown fox jumps over the lazy dog", 0x0B242D361FDA71BCULL},
+};
+
+static const size_t   XXH64_COUNTING_LENGTH = 100;                                 // bytes 0, 1, ... 99: three stripes + 4 bytes
+static const uint64_t XXH64_COUNTING        = 0x6AC1E58032166597ULL;
+
+template <class Hasher>
+static double measure_hash(Hasher hasher, const std::vector<unsigned char> &buffer, size_t key_length, uint64_t &checksum)
+{
+    size_t calls = BENCH_BYTE_BUDGET / key_length;
+
+    auto start = std::chrono::steady_clock::now();
+
+    checksum = 0;
+    size_t offset = 0;
+    for (size_t call = 0; call < calls; ++call)
+    {
+        checksum += hasher(buffer.data() + offset, key_length);
+
+        offset += key_length;
+        if (offset + key_length > buffer.size())
+        {
+            offset = 0;
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return static_cast<double> (calls * key_length) / elapsed.count() / 1e9;
+}
+
+static bool check_hash_bytes(const std::vector<unsigned char> &buffer)
+{
+    for (const ReferenceHash &reference : XXH64_REFERENCES)
+    {
+        if (hash_bytes(reference.input.data(), reference.input.size()) != reference.hash)
+        {
+            std::cerr << "ERROR: hash_bytes of \"" << reference.input << "\" differs from XXH64" << std::endl;
+
+            return false;
+        }
+    }
+
+    unsigned char counting[XXH64_COUNTING_LENGTH];
+    for (size_t index = 0; index < XXH64_COUNTING_LENGTH; ++index)
+    {
+        counting[index] = static_cast<unsigned char> (index);
+    }
+
+    if (hash_bytes(counting, XXH64_COUNTING_LENGTH) != XXH64_COUNTING)
+    {
+        std::cerr << "ERROR: hash_bytes of " << XXH64_COUNTING_LENGTH << " counting bytes differs from XXH64" << std::endl;
+
+        return false;
+    }
+
+    const size_t CHECKED_LENGTH = 100003;
+
+    IncrementalHash state;
+    for (size_t offset = 0, piece = 1; offset < CHECKED_LENGTH; offset += piece, piece = piece % 61 + 7)
+    {
+        state.update(buffer.data() + offset, std::min(piece, CHECKED_LENGTH - offset));
+    }
+
+    if (state.digest() != hash_bytes(buffer.data(), CHECKED_LENGTH))
+    {
+        std::cerr << "ERROR: IncrementalHash differs from hash_bytes" << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    std::mt19937_64 generator(1);
+
+    std::vector<unsigned char> buffer(BENCH_BUFFER_SIZE);
+    for (unsigned char &byte : buffer)
+    {
+        byte = static_cast<unsigned char> (generator());
+    }
+
+    if (!check_hash_bytes(buffer))
+    {
+        return EXIT_FAILURE;
+    }
+
+    auto xxh64 = [](const unsigned char *data, size_t length)
+    {
+        return hash_bytes(data, length);
+    };
+
+    auto std_hash = [](const unsigned char *data, size_t length)
+    {
+        return static_cast<uint64_t> (std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char *> (data), length)));
+    };
+
+    for (size_t key_length : BENCH_KEY_LENGTHS)
+    {
+        uint64_t xxh64_checksum    = 0;
+        uint64_t std_hash_checksum = 0;
+
+        double xxh64_rate    = measure_hash(xxh64, buffer, key_length, xxh64_checksum);
+        double std_hash_rate = measure_hash(std_hash, buffer, key_length, std_hash_checksum);
+
+        std::cout << std::fixed << std::setprecision(2) << "key " << key_length << " bytes: hash_bytes " << xxh64_rate
+                  << ", std::hash " << std_hash_rate << " GB/s (checksums " << std::hex << xxh64_checksum << ", "
+                  << std_hash_checksum << std::dec << ")" << std::endl;
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include "array.hpp"
+#include "vector.hpp"
+
+
+//---------------------------Byte hashing------------------------------------------
+// XXH64: four independent 64-bit lanes over 32-byte stripes, so the bulk loop
+// keeps several multipliers busy at once. The same algorithm runs one-shot
+// (hash_bytes) and incrementally (IncrementalHash) with identical results.
+uint64_t hash_bytes(const void *data, size_t length, uint64_t seed = 0);
+
+
+class IncrementalHash
+{
+public:
+
+    explicit IncrementalHash(uint64_t seed = 0);
+
+    void update(const void *data, size_t length);
+
+    // Hash of everything passed to update() so far; more data may be appended afterwards.
+    uint64_t digest() const;
+
+    uint64_t length() const
+    {
+        return total_length_;
+    }
+
+private:
+
+    static const size_t STRIPE_SIZE = 32;
+
+    uint64_t seed_         = 0;
+    uint64_t lanes_[4]     = {};
+    uint64_t total_length_ = 0;
+
+    unsigned char buffer_[STRIPE_SIZE] = {};
+    size_t buffered_ = 0;
+};
+
+
+//---------------------------Element hashing---------------------------------------
+// Types whose equal values have equal bytes are hashed as one byte block,
+// others as the sequence of their std::hash values.
+template <class Type>
+const bool IS_BYTEWISE_HASHABLE = std::has_unique_object_representations<Type>::value;
+
+template <class Type>
+void hash_append(IncrementalHash &state, const Type *data, size_t size)
+{
+    if constexpr (IS_BYTEWISE_HASHABLE<Type>)
+    {
+        state.update(data, size * sizeof(Type));
+    }
+    else
+    {
+        for (size_t index = 0; index < size; ++index)
+        {
+            uint64_t elem_hash = static_cast<uint64_t> (std::hash<Type>()(data[index]));
+            state.update(&elem_hash, sizeof(elem_hash));
+        }
+    }
+}
+
+template <class Type>
+uint64_t hash_elements(const Type *data, size_t size, uint64_t seed = 0)
+{
+    if constexpr (IS_BYTEWISE_HASHABLE<Type>)
+    {
+        return hash_bytes(data, size * sizeof(Type), seed);
+    }
+    else
+    {
+        IncrementalHash state(seed);
+        hash_append(state, data, size);
+
+        return state.digest();
+    }
+}
+
+
+//---------------------------Rolling hash------------------------------------------
+// Follows a vector that only grows at the back: append what was pushed,
+// digest() equals std::hash of the whole vector at that moment.
+template <class Type>
+class RollingVectorHash
+{
+public:
+
+    void append(const Type &value)
+    {
+        hash_append(state_, &value, 1);
+    }
+
+    void append(const Type *data, size_t size)
+    {
+        hash_append(state_, data, size);
+    }
+
+    uint64_t digest() const
+    {
+        return state_.digest();
+    }
+
+private:
+
+    IncrementalHash state_;
+};
+
+
+//---------------------------std::hash---------------------------------------------
+template <class Type>
+struct std::hash<Vector<Type>>
+{
+    size_t operator ()(const Vector<Type> &vector) const
+    {
+        return static_cast<size_t> (hash_elements(vector.data(), vector.size()));
+    }
+};
+
+template <>
+struct std::hash<Vector<bool>>
+{
+    size_t operator ()(const Vector<bool> &vector) const
+    {
+        return static_cast<size_t> (hash_bytes(vector.data(), vector.word_count() * sizeof(uint64_t), vector.size()));
+    }
+};
+
+template <class Type, size_t Capacity>
+struct std::hash<Array<Type, Capacity>>
+{
+    size_t operator ()(const Array<Type, Capacity> &array) const
+    {
+        return static_cast<size_t> (hash_elements(array.data(), Capacity));
+    }
+};
+
+template <size_t Capacity>
+struct std::hash<Array<bool, Capacity>>
+{
+    size_t operator ()(const Array<bool, Capacity> &array) const
+    {
+        return static_cast<size_t> (hash_bytes(array.data(), sizeof(array.words_)));
+    }
+};
+
+
+#endif
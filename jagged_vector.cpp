@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <utility>
+#include <vector>
+#include "jagged_vector.hpp"
+
+
+//---------------------------Allocation counting-----------------------------------
+// Counts allocations and requested bytes, so the memory benchmark compares what
+// each layout really takes from the heap.
+
+static size_t allocation_count = 0;
+static size_t allocated_bytes  = 0;
+
+void *operator new(size_t size)
+{
+    ++allocation_count;
+    allocated_bytes += size;
+
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+// Kept out of line: inlined into std::vector, free() would be paired with the builtin
+// operator new and trip -Wmismatched-new-delete.
+__attribute__((noinline)) void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+
+//---------------------------Checks------------------------------------------------
+// Random row edits are mirrored on std::vector<std::vector<int>>: after every step
+// the rows must match, and compact() must keep them and leave no gaps.
+
+using NestedModel = std::vector<std::vector<int>>;
+
+static bool same_rows(const JaggedVector<int> &jagged, const NestedModel &model)
+{
+    if (jagged.rows() != model.size())
+    {
+        return false;
+    }
+
+    size_t size = 0;
+    for (size_t row = 0; row < model.size(); ++row)
+    {
+        JaggedVector<int>::ConstRow values = jagged[row];
+        if (!std::equal(values.begin(), values.end(), model[row].begin(), model[row].end()))
+        {
+            return false;
+        }
+
+        size += model[row].size();
+    }
+
+    return jagged.size() == size;
+}
+
+static bool check_random_edits(size_t operation_count, unsigned seed)
+{
+    std::mt19937 generator(seed);
+
+    JaggedVector<int> jagged;
+    NestedModel model;
+
+    for (size_t operation = 0; operation < operation_count; ++operation)
+    {
+        int value        = static_cast<int> (generator() % 1000);
+        size_t row       = model.empty() ? 0 : generator() % model.size();
+        const char *name = nullptr;
+
+        switch (model.empty() ? 0 : generator() % 7)
+        {
+            case 0:
+            {
+                name = "push_back_row";
+                std::vector<int> values(generator() % 8, value);
+                jagged.push_back_row(values);
+                model.push_back(values);
+                break;
+            }
+
+            case 1:
+            case 2:
+                name = "push_back_to_last_row";                                     // fills a gap the last row left first
+                jagged.push_back_to_last_row(value);
+                model.back().push_back(value);
+                break;
+
+            case 3:
+            {
+                if (model[row].empty())
+                {
+                    continue;
+                }
+
+                size_t index = generator() % model[row].size();
+
+                name = "erase_from_row";
+                jagged.erase_from_row(row, index);
+                model[row].erase(model[row].begin() + static_cast<ptrdiff_t> (index));
+                break;
+            }
+
+            case 4:
+            {
+                name = "truncate_row";
+                size_t new_size = model[row].empty() ? 0 : generator() % model[row].size();
+                jagged.truncate_row(row, new_size);
+                model[row].resize(std::min(new_size, model[row].size()));
+                break;
+            }
+
+            case 5:
+                name = "pop_back_row";
+                jagged.pop_back_row();
+                model.pop_back();
+                break;
+
+            default:
+                name = "compact";
+                jagged.compact();
+                if (jagged.gaps() != 0)
+                {
+                    std::cerr << "ERROR: compact() left " << jagged.gaps() << " gaps" << std::endl;
+
+                    return false;
+                }
+                break;
+        }
+
+        if (!same_rows(jagged, model))
+        {
+            std::cerr << "ERROR: " << name << " left different rows than std::vector<std::vector<int>>" << std::endl;
+
+            return false;
+        }
+    }
+
+    jagged.compact();
+
+    return same_rows(jagged, model) && (jagged.gaps() == 0);
+}
+
+// A truncated last row keeps its slots as a gap, and appending reuses them.
+static bool check_append_after_truncate()
+{
+    JaggedVector<int> jagged;
+    jagged.push_back_row({1, 2, 3, 4});
+
+    jagged.truncate_row(0, 1);
+    size_t gaps_after_truncate = jagged.gaps();
+
+    jagged.push_back_to_last_row(5);
+    jagged.push_back_to_last_row(6);
+    jagged.push_back_to_last_row(7);
+    jagged.push_back_to_last_row(8);
+
+    NestedModel model = {{1, 5, 6, 7, 8}};
+
+    return (gaps_after_truncate == 3) && (jagged.gaps() == 0) && same_rows(jagged, model);
+}
+
+// Values keep the order of the items inside every row.
+static bool check_group_by_row(size_t item_count, size_t row_count, unsigned seed)
+{
+    std::mt19937 generator(seed);
+
+    std::vector<std::pair<size_t, int>> items(item_count);
+    NestedModel model(row_count);
+    for (auto &item : items)
+    {
+        item = {generator() % row_count, static_cast<int> (generator() % 1000)};
+        model[item.first].push_back(item.second);
+    }
+
+    JaggedVector<int> jagged = JaggedVector<int>::group_by_row(row_count, items,
+                                                               [](const auto &item){ return item.first; },
+                                                               [](const auto &item){ return item.second; });
+
+    return same_rows(jagged, model) && (jagged.gaps() == 0);
+}
+
+static bool check_jagged_vector()
+{
+    const size_t RANDOM_OPS_COUNT = 20000;
+    const unsigned SEEDS[]        = {1, 2, 3};
+
+    bool passed = check_append_after_truncate();
+    for (unsigned seed : SEEDS)
+    {
+        passed = check_random_edits(RANDOM_OPS_COUNT, seed) && passed;
+        passed = check_group_by_row(RANDOM_OPS_COUNT, 100, seed) && passed;
+    }
+
+    if (!passed)
+    {
+        std::cerr << "ERROR: JaggedVector checks failed" << std::endl;
+    }
+
+    return passed;
+}
+
+
+//---------------------------Benchmark---------------------------------------------
+// Builds the same rows as JaggedVector<int> and as Vector<Vector<int>>, then sums
+// them all several times: prints build time, heap use and traversal speed.
+
+const size_t BENCH_ROW_COUNT    = 1 << 20;
+const size_t BENCH_MAX_ROW_SIZE = 16;
+const size_t BENCH_TRAVERSALS   = 16;
+
+template <class Function>
+static double measure_ms(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count();
+}
+
+static bool bench_layouts()
+{
+    std::mt19937 generator(1);
+
+    Vector<size_t> row_sizes(BENCH_ROW_COUNT);
+    for (size_t &row_size : row_sizes)
+    {
+        row_size = generator() % BENCH_MAX_ROW_SIZE;
+    }
+
+    JaggedVector<int> jagged;
+    Vector<Vector<int>> nested;
+
+    size_t jagged_allocations = allocation_count;
+    size_t jagged_bytes       = allocated_bytes;
+    double jagged_build_ms    = measure_ms([&]()
+    {
+        for (size_t row = 0; row < BENCH_ROW_COUNT; ++row)
+        {
+            jagged.push_back_row({});
+            for (size_t index = 0; index < row_sizes[row]; ++index)
+            {
+                jagged.push_back_to_last_row(static_cast<int> (index));
+            }
+        }
+    });
+    jagged_allocations = allocation_count - jagged_allocations;
+    jagged_bytes       = allocated_bytes - jagged_bytes;
+
+    size_t nested_allocations = allocation_count;
+    size_t nested_bytes       = allocated_bytes;
+    double nested_build_ms    = measure_ms([&]()
+    {
+        for (size_t row = 0; row < BENCH_ROW_COUNT; ++row)
+        {
+            nested.push_back(Vector<int>());
+            for (size_t index = 0; index < row_sizes[row]; ++index)
+            {
+                nested[row].push_back(static_cast<int> (index));
+            }
+        }
+    });
+    nested_allocations = allocation_count - nested_allocations;
+    nested_bytes       = allocated_bytes - nested_bytes;
+
+    int64_t jagged_sum = 0;
+    int64_t nested_sum = 0;
+
+    double jagged_traverse_ms = measure_ms([&]()
+    {
+        for (size_t traversal = 0; traversal < BENCH_TRAVERSALS; ++traversal)
+        {
+            for (size_t row = 0; row < jagged.rows(); ++row)
+            {
+                for (int value : jagged[row])
+                {
+                    jagged_sum += value;
+                }
+            }
+        }
+    });
+
+    double nested_traverse_ms = measure_ms([&]()
+    {
+        for (size_t traversal = 0; traversal < BENCH_TRAVERSALS; ++traversal)
+        {
+            for (size_t row = 0; row < nested.size(); ++row)
+            {
+                for (int value : nested[row])
+                {
+                    nested_sum += value;
+                }
+            }
+        }
+    });
+
+    std::cout << std::fixed << std::setprecision(1) << BENCH_ROW_COUNT << " rows, " << jagged.size() << " elements" << std::endl
+              << "build: jagged " << jagged_build_ms << " ms, nested " << nested_build_ms << " ms" << std::endl
+              << "allocated while building: jagged " << jagged_allocations << " allocations, " << jagged_bytes / 1024 << " KiB; nested "
+              << nested_allocations << " allocations, " << nested_bytes / 1024 << " KiB" << std::endl
+              << "traversal: jagged " << jagged_traverse_ms / BENCH_TRAVERSALS << " ms, nested "
+              << nested_traverse_ms / BENCH_TRAVERSALS << " ms" << std::endl;
+
+    if (jagged_sum != nested_sum)
+    {
+        std::cerr << "ERROR: JaggedVector and Vector<Vector<int>> hold different elements" << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    bool passed = check_jagged_vector();
+    passed = bench_layouts() && passed;
+
+    return passed ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,345 @@
+#ifndef JAGGED_VECTOR_HPP
+#define JAGGED_VECTOR_HPP
+
+
+#include <algorithm>
+#include <initializer_list>
+#include <span>
+#include "vector.hpp"
+
+
+//---------------------------Class JaggedVector------------------------------------
+// Rows of different lengths in compressed sparse row form: the elements of all rows
+// lie one after another in elements_, row r starts at offsets_[r], and offsets_ has
+// one more entry that marks the end of the storage. Compared to Vector<Vector<Type>>
+// there is no allocation per row and traversal reads memory in order.
+//
+// Edits that shorten a row in the middle leave a gap after it (row_ends_[r] is then
+// below offsets_[r + 1]); compact() closes the gaps.
+template <class Type>
+class JaggedVector
+{
+    static_assert(!std::is_same_v<Type, bool>, "Vector<bool> is bit packed, so its rows cannot be spans");
+
+public:
+
+    using Row      = std::span<Type>;
+    using ConstRow = std::span<const Type>;
+
+//--------------------Constructors, destructors and =------------------------------
+    JaggedVector()
+      : offsets_(1, 0)
+    {}
+
+    // Two-pass CSR build from (row, value) items: rows are counted first and the
+    // storage is sized once, then every value is assigned to its final slot. The
+    // slots are default-constructed by assign_row_sizes(), so Type needs a default
+    // constructor and each element is built and then assigned.
+    template <class Range, class RowOf, class ValueOf>
+    static JaggedVector group_by_row(size_t row_count, const Range &items, RowOf row_of, ValueOf value_of)
+    {
+        Vector<size_t> row_sizes(row_count, 0);
+        for (const auto &item : items)
+        {
+            size_t row = row_of(item);
+            if (row >= row_count)
+            {
+                REPORT_EVENT(DiagCode::GROUP_INTO_MISSING_ROW, row, row_count);
+
+                throw std::out_of_range("ERROR: attempt to group into a missing row");
+            }
+
+            ++row_sizes[row];
+        }
+
+        JaggedVector result;
+        result.assign_row_sizes(row_sizes);
+
+        Vector<size_t> cursors = result.offsets_;
+        for (const auto &item : items)
+        {
+            result.elements_[cursors[row_of(item)]++] = value_of(item);
+        }
+
+        return result;
+    }
+
+//---------------------------Size and capacity-------------------------------------
+
+    bool empty() const
+    {
+        return rows() == 0;
+    }
+
+    size_t rows() const
+    {
+        return row_ends_.size();
+    }
+
+    // Elements in all rows, gaps are not counted.
+    size_t size() const
+    {
+        return elements_.size() - gaps_;
+    }
+
+    size_t row_size(size_t row) const
+    {
+        return row_ends_[row] - offsets_[row];
+    }
+
+    // Elements left in gaps by row edits since the last compact().
+    size_t gaps() const
+    {
+        return gaps_;
+    }
+
+    void reserve(size_t row_count, size_t element_count)
+    {
+        offsets_.reserve(row_count + 1);
+        row_ends_.reserve(row_count);
+        elements_.reserve(element_count);
+    }
+
+//-----------------------------Operating elements----------------------------------
+
+    Row operator [](size_t row)
+    {
+        return Row(elements_.data() + offsets_[row], row_size(row));
+    }
+
+    ConstRow operator [](size_t row) const
+    {
+        return ConstRow(elements_.data() + offsets_[row], row_size(row));
+    }
+
+    Row at(size_t row)
+    {
+        check_row(row);
+
+        return this->operator[](row);
+    }
+
+    ConstRow at(size_t row) const
+    {
+        check_row(row);
+
+        return this->operator[](row);
+    }
+
+    Row back()
+    {
+        return this->operator[](rows() - 1);
+    }
+
+//---------------------------Modifiers---------------------------------------------
+
+    // range must not be a row of this container: appending may move the storage.
+    template <class Range>
+    void push_back_row(const Range &range)
+    {
+        size_t row_begin = elements_.size();
+        try
+        {
+            if constexpr (requires { range.size(); })
+            {
+                grow_elements(row_begin + range.size());
+            }
+
+            for (const auto &value : range)
+            {
+                elements_.push_back(value);
+            }
+
+            row_ends_.push_back(elements_.size());
+            offsets_.push_back(elements_.size());
+        }
+        catch (...)
+        {
+            elements_.resize(row_begin);
+            row_ends_.resize(offsets_.size() - 1);
+
+            throw;
+        }
+    }
+
+    void push_back_row(std::initializer_list<Type> values)
+    {
+        push_back_row(std::span<const Type>(values.begin(), values.size()));
+    }
+
+    void push_back_to_last_row(const Type &value)
+    {
+        if (empty())
+        {
+            REPORT_EVENT(DiagCode::APPEND_TO_MISSING_ROW);
+
+            throw std::out_of_range("ERROR: attempt to append to a missing row");
+        }
+
+        size_t &row_end = row_ends_[rows() - 1];
+        if (row_end < elements_.size())                                             // the last row has a gap
+        {
+            elements_[row_end] = value;
+            --gaps_;
+        }
+        else
+        {
+            elements_.push_back(value);
+            offsets_[rows()] = elements_.size();
+        }
+
+        ++row_end;
+    }
+
+    void pop_back_row()
+    {
+        if (empty())
+        {
+            return;
+        }
+
+        size_t row = rows() - 1;
+
+        gaps_ -= offsets_[row + 1] - row_ends_[row];
+        elements_.resize(offsets_[row]);
+
+        row_ends_.pop_back();
+        offsets_.pop_back();
+    }
+
+    void erase_from_row(size_t row, size_t index)
+    {
+        check_row(row);
+        if (index >= row_size(row))
+        {
+            REPORT_EVENT(DiagCode::ERASE_OUT_OF_BOUNDS, index, row_size(row));
+
+            throw std::out_of_range("ERROR: attempt to erase out of bounds");
+        }
+
+        Type *row_data = elements_.data() + offsets_[row];
+        std::move(row_data + index + 1, row_data + row_size(row), row_data + index);
+
+        --row_ends_[row];
+        ++gaps_;
+    }
+
+    void truncate_row(size_t row, size_t new_size)
+    {
+        check_row(row);
+        if (new_size >= row_size(row))
+        {
+            return;
+        }
+
+        gaps_ += row_size(row) - new_size;
+        row_ends_[row] = offsets_[row] + new_size;
+    }
+
+    void clear_row(size_t row)
+    {
+        truncate_row(row, 0);
+    }
+
+    void clear()
+    {
+        elements_.clear();
+        row_ends_.clear();
+        offsets_.resize(1);
+
+        gaps_ = 0;
+    }
+
+    // First pass of a CSR build: rows get the given sizes, filled with value,
+    // and can then be written through operator[].
+    void assign_row_sizes(const Vector<size_t> &row_sizes, const Type &value = Type())
+    {
+        Vector<size_t> new_offsets(row_sizes.size() + 1, 0);
+        Vector<size_t> new_ends   (row_sizes.size(), 0);
+        for (size_t row = 0; row < row_sizes.size(); ++row)
+        {
+            new_offsets[row + 1] = new_offsets[row] + row_sizes[row];
+            new_ends[row]        = new_offsets[row + 1];
+        }
+
+        Vector<Type> new_elements(new_offsets[row_sizes.size()], value);
+
+        elements_.swap(new_elements);
+        offsets_.swap(new_offsets);
+        row_ends_.swap(new_ends);
+
+        gaps_ = 0;
+    }
+
+    // Moves rows together so there are no gaps left; spans taken before are invalidated.
+    void compact()
+    {
+        if (gaps_ == 0)
+        {
+            return;
+        }
+
+        size_t write = 0;
+        for (size_t row = 0; row < rows(); ++row)
+        {
+            size_t length = row_size(row);
+
+            if (offsets_[row] != write)                                             // rows before the first gap stay in place
+            {
+                std::move(elements_.data() + offsets_[row], elements_.data() + row_ends_[row], elements_.data() + write);
+            }
+
+            offsets_[row]  = write;
+            write         += length;
+            row_ends_[row] = write;
+        }
+
+        offsets_[rows()] = write;
+        elements_.resize(write);
+
+        gaps_ = 0;
+    }
+
+    void swap(JaggedVector &other)
+    {
+        elements_.swap(other.elements_);
+        offsets_.swap(other.offsets_);
+        row_ends_.swap(other.row_ends_);
+        std::swap(gaps_, other.gaps_);
+    }
+
+private:
+//--------------------------Utility functions--------------------------------------
+
+    void check_row(size_t row) const
+    {
+        if (row >= rows())
+        {
+            REPORT_EVENT(DiagCode::ROW_OUT_OF_BOUNDS, row, rows());
+
+            throw std::out_of_range("ERROR: attempt to get row out of bounds");
+        }
+    }
+
+    // Vector::reserve() gives exactly the requested capacity, so grow geometrically
+    // here to keep appending many rows linear.
+    void grow_elements(size_t required_size)
+    {
+        if (required_size > elements_.capacity())
+        {
+            elements_.reserve(calculate_enough_capacity(required_size));
+        }
+    }
+
+private:
+//----------------------------Variables--------------------------------------------
+
+    Vector<Type>   elements_;
+    Vector<size_t> offsets_;                                                        // rows() + 1 entries
+    Vector<size_t> row_ends_;
+
+    size_t gaps_ = 0;
+};
+
+
+#endif
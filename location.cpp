@@ -1,8 +1,8 @@
 #include "location.hpp"
 
+#include "diagnostics.hpp"
+
 void print_location(const Location &location)
 {
-    std::cout << "__FILE__: " << location.file_ << std::endl;
-    std::cout << "__FUNC__: " << location.func_ << std::endl;
-    std::cout << "__LINE__: " << location.line_ << std::endl << std::endl;
+    report_event(location, DiagCode::LOCATION);
 }
\ No newline at end of file
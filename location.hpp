@@ -3,13 +3,16 @@
 
 #include <iostream>
 
+#define CURRENT_LOCATION Location(__FILE__, __func__, __LINE__)
+
+
 struct Location
 {
 public:
 
-    Location() = default;
+    constexpr Location() = default;
 
-    Location(const char *file, const char *func, int line)
+    constexpr Location(const char *file, const char *func, int line)
       : file_(file),
         func_(func),
         line_(line)
@@ -21,6 +24,7 @@ public:
 };
 
 
+// Reported through the diagnostics sink (see diagnostics.hpp).
 void print_location(const Location &location = Location());
 
 
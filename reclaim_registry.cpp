@@ -0,0 +1,90 @@
+#include "reclaim_registry.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+struct ReclaimEntry
+{
+    void *object_           = nullptr;
+    ReclaimSlackFunc slack_ = nullptr;
+    ReclaimTrimFunc  trim_  = nullptr;
+};
+
+// Keyed by address: every registered container unregisters on destruction, so
+// finding its entry must not depend on how many others are registered.
+typedef std::unordered_map<void *, ReclaimEntry> ReclaimEntries;
+
+
+static std::mutex &registry_mutex()
+{
+    static std::mutex mutex;
+
+    return mutex;
+}
+
+static ReclaimEntries &registry_entries()
+{
+    static ReclaimEntries entries;
+
+    return entries;
+}
+
+
+void register_reclaimable(void *object, ReclaimSlackFunc slack, ReclaimTrimFunc trim)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex());
+
+    registry_entries()[object] = ReclaimEntry{object, slack, trim};
+}
+
+void unregister_reclaimable(void *object)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex());
+
+    registry_entries().erase(object);
+}
+
+size_t reclaimable_bytes()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex());
+
+    size_t result = 0;
+    for (const auto &[object, entry] : registry_entries())
+    {
+        result += entry.slack_(object);
+    }
+
+    return result;
+}
+
+size_t reclaim(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex());
+
+    std::vector<std::pair<size_t, ReclaimEntry>> candidates;
+    for (const auto &[object, entry] : registry_entries())
+    {
+        size_t slack = entry.slack_(object);
+        if (slack != 0)
+        {
+            candidates.push_back(std::make_pair(slack, entry));
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<size_t, ReclaimEntry> &lhs, const std::pair<size_t, ReclaimEntry> &rhs)
+              {
+                  return lhs.first > rhs.first;
+              });
+
+    size_t released = 0;
+    for (size_t index = 0; (index < candidates.size()) && (released < bytes); ++index)
+    {
+        released += candidates[index].second.trim_(candidates[index].second.object_);
+    }
+
+    return released;
+}
@@ -0,0 +1,26 @@
+#ifndef RECLAIM_REGISTRY_HPP
+#define RECLAIM_REGISTRY_HPP
+
+
+#include <cstddef>
+
+
+// Process-wide list of containers that agreed to give memory back under pressure.
+// Containers register themselves by address together with two callbacks:
+//   slack - how many bytes a trim would release right now;
+//   trim  - release them and return how many bytes were actually freed.
+// reclaim() trims registered objects biggest slack first. It runs the callbacks
+// on the calling thread, so it must not race with users of the registered objects.
+
+typedef size_t (*ReclaimSlackFunc)(const void *object);
+typedef size_t (*ReclaimTrimFunc) (void *object);
+
+
+void register_reclaimable  (void *object, ReclaimSlackFunc slack, ReclaimTrimFunc trim);
+void unregister_reclaimable(void *object);
+
+size_t reclaimable_bytes();
+size_t reclaim(size_t bytes);
+
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+//---------------------------Class RingBuffer--------------------------------------
+// Bounded lock-free queue for many producers and many consumers (D. Vyukov's scheme):
+// every cell carries a sequence number telling whose turn it is, so producers and
+// consumers only contend on their own position counter. Capacity must be a power of two.
+template <class Type, size_t Capacity>
+class RingBuffer
+{
+    static_assert((Capacity != 0) && ((Capacity & (Capacity - 1)) == 0), "RingBuffer capacity must be a power of two");
+
+public:
+
+    RingBuffer()
+    {
+        for (size_t index = 0; index < Capacity; ++index)
+        {
+            cells_[index].sequence_.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer &that) = delete;
+    RingBuffer &operator =(const RingBuffer &that) = delete;
+
+    // Returns false if the queue is full.
+    bool try_push(const Type &value)
+    {
+        size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell       = cells_[position & (Capacity - 1)];
+            size_t sequence  = cell.sequence_.load(std::memory_order_acquire);
+            intptr_t lag     = static_cast<intptr_t> (sequence) - static_cast<intptr_t> (position);
+
+            if (lag == 0)
+            {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value_ = value;
+                    cell.sequence_.store(position + 1, std::memory_order_release);
+
+                    return true;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty.
+    bool try_pop(Type &value)
+    {
+        size_t position = dequeue_position_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell       = cells_[position & (Capacity - 1)];
+            size_t sequence  = cell.sequence_.load(std::memory_order_acquire);
+            intptr_t lag     = static_cast<intptr_t> (sequence) - static_cast<intptr_t> (position + 1);
+
+            if (lag == 0)
+            {
+                if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    value = cell.value_;
+                    cell.sequence_.store(position + Capacity, std::memory_order_release);
+
+                    return true;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Only a snapshot: producers and consumers may move on right after it is taken.
+    size_t size() const
+    {
+        size_t enqueued = enqueue_position_.load(std::memory_order_relaxed);
+        size_t dequeued = dequeue_position_.load(std::memory_order_relaxed);
+
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    size_t capacity() const
+    {
+        return Capacity;
+    }
+
+private:
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence_{0};
+        Type value_ = Type();
+    };
+
+    static const size_t CACHE_LINE = 64;
+
+    Cell cells_[Capacity];
+
+    alignas(CACHE_LINE) std::atomic<size_t> enqueue_position_{0};
+    alignas(CACHE_LINE) std::atomic<size_t> dequeue_position_{0};
+};
+
+
+#endif
@@ -0,0 +1,229 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "tensor_view.hpp"
+
+
+//---------------------------Layout benchmark--------------------------------------
+// Runs a transpose, a 7-point stencil and plane sums along every axis over
+// row-major and tiled tensors and prints millions of elements per second. The
+// layouts must give the same results, otherwise the program fails.
+
+const size_t BENCH_MATRIX_EDGE = 2048;
+const size_t BENCH_GRID_EDGE   = 160;
+const size_t BENCH_REPEATS     = 4;
+
+using Tiled2D = LayoutTiled<32>;
+using Tiled3D = LayoutTiled<8>;
+
+template <class Function>
+static double measure(size_t elements, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t repeat = 0; repeat < BENCH_REPEATS; ++repeat)
+    {
+        function();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return static_cast<double> (BENCH_REPEATS * elements) / elapsed.count() / 1e6;
+}
+
+template <class Layout, size_t Rank>
+static Vector<uint32_t> make_storage(const Array<size_t, Rank> &extents)
+{
+    return Vector<uint32_t>(TensorView<uint32_t, Rank, Layout>(nullptr, extents).required_span_size(), 0);
+}
+
+template <class Layout, size_t Rank>
+static void fill_pattern(const TensorView<uint32_t, Rank, Layout> &view)
+{
+    uint32_t value = 1;
+    for_each_index_blocked(view, 0, [&view, &value](const Array<size_t, Rank> &index)
+    {
+        value = value * 1664525 + 1013904223;
+        view[index] = value;
+    });
+}
+
+template <class LeftLayout, class RightLayout, size_t Rank>
+static bool same_elements(const TensorView<uint32_t, Rank, LeftLayout> &left, const TensorView<uint32_t, Rank, RightLayout> &right)
+{
+    bool same = true;
+    for_each_index_blocked(left, 0, [&left, &right, &same](const Array<size_t, Rank> &index)
+    {
+        same = same && (left[index] == right[index]);
+    });
+
+    return same;
+}
+
+//---------------------------Transpose---------------------------------------------
+
+// dest(j, i) = src(i, j), walking src in row-major order or block by block.
+template <class Layout>
+static void transpose(const TensorView<uint32_t, 2, Layout> &dest, const TensorView<uint32_t, 2, Layout> &src, size_t block)
+{
+    for_each_index_blocked(src, block, [&dest, &src](const Array<size_t, 2> &index)
+    {
+        dest(index[1], index[0]) = src[index];
+    });
+}
+
+static bool bench_transpose()
+{
+    const Array<size_t, 2> EXTENTS = {BENCH_MATRIX_EDGE, BENCH_MATRIX_EDGE};
+    const size_t ELEMENTS          = BENCH_MATRIX_EDGE * BENCH_MATRIX_EDGE;
+
+    Vector<uint32_t> row_major_src  = make_storage<LayoutRowMajor>(EXTENTS);
+    Vector<uint32_t> row_major_dest = make_storage<LayoutRowMajor>(EXTENTS);
+    Vector<uint32_t> tiled_src      = make_storage<Tiled2D>(EXTENTS);
+    Vector<uint32_t> tiled_dest     = make_storage<Tiled2D>(EXTENTS);
+
+    TensorView<uint32_t, 2, LayoutRowMajor> row_major_src_view (row_major_src,  EXTENTS);
+    TensorView<uint32_t, 2, LayoutRowMajor> row_major_dest_view(row_major_dest, EXTENTS);
+    TensorView<uint32_t, 2, Tiled2D>        tiled_src_view     (tiled_src,      EXTENTS);
+    TensorView<uint32_t, 2, Tiled2D>        tiled_dest_view    (tiled_dest,     EXTENTS);
+
+    fill_pattern(row_major_src_view);
+    copy_layout(tiled_src_view, row_major_src_view);
+
+    double row_major_rate = measure(ELEMENTS, [&](){ transpose(row_major_dest_view, row_major_src_view, 0); });
+    double blocked_rate   = measure(ELEMENTS, [&](){ transpose(row_major_dest_view, row_major_src_view, Tiled2D::BLOCK); });
+    double tiled_rate     = measure(ELEMENTS, [&](){ transpose(tiled_dest_view, tiled_src_view, Tiled2D::BLOCK); });
+
+    std::cout << "transpose " << BENCH_MATRIX_EDGE << "^2: row-major " << row_major_rate << ", row-major blocked "
+              << blocked_rate << ", tiled " << tiled_rate << " Melements/s" << std::endl;
+
+    return same_elements(row_major_dest_view, tiled_dest_view);
+}
+
+//---------------------------Stencil-----------------------------------------------
+
+// dest = sum of src over the point and its 6 neighbours, on the interior of the grid.
+template <class Layout>
+static void stencil(const TensorView<uint32_t, 3, Layout> &dest, const TensorView<uint32_t, 3, Layout> &src)
+{
+    const size_t EDGE = src.extent(0);
+
+    TensorView<uint32_t, 3, Layout> interior = dest.subview({1, 1, 1}, {EDGE - 1, EDGE - 1, EDGE - 1});
+
+    for_each_index_blocked(interior, Layout::BLOCK, [&interior, &src](const Array<size_t, 3> &index)
+    {
+        size_t x = index[0] + 1;
+        size_t y = index[1] + 1;
+        size_t z = index[2] + 1;
+
+        interior[index] = src(x, y, z) +
+                          src(x - 1, y, z) + src(x + 1, y, z) +
+                          src(x, y - 1, z) + src(x, y + 1, z) +
+                          src(x, y, z - 1) + src(x, y, z + 1);
+    });
+}
+
+static bool bench_stencil()
+{
+    const Array<size_t, 3> EXTENTS = {BENCH_GRID_EDGE, BENCH_GRID_EDGE, BENCH_GRID_EDGE};
+    const size_t ELEMENTS          = (BENCH_GRID_EDGE - 2) * (BENCH_GRID_EDGE - 2) * (BENCH_GRID_EDGE - 2);
+
+    Vector<uint32_t> row_major_src  = make_storage<LayoutRowMajor>(EXTENTS);
+    Vector<uint32_t> row_major_dest = make_storage<LayoutRowMajor>(EXTENTS);
+    Vector<uint32_t> tiled_src      = make_storage<Tiled3D>(EXTENTS);
+    Vector<uint32_t> tiled_dest     = make_storage<Tiled3D>(EXTENTS);
+
+    TensorView<uint32_t, 3, LayoutRowMajor> row_major_src_view (row_major_src,  EXTENTS);
+    TensorView<uint32_t, 3, LayoutRowMajor> row_major_dest_view(row_major_dest, EXTENTS);
+    TensorView<uint32_t, 3, Tiled3D>        tiled_src_view     (tiled_src,      EXTENTS);
+    TensorView<uint32_t, 3, Tiled3D>        tiled_dest_view    (tiled_dest,     EXTENTS);
+
+    fill_pattern(row_major_src_view);
+    copy_layout(tiled_src_view, row_major_src_view);
+
+    double row_major_rate = measure(ELEMENTS, [&](){ stencil(row_major_dest_view, row_major_src_view); });
+    double tiled_rate     = measure(ELEMENTS, [&](){ stencil(tiled_dest_view, tiled_src_view); });
+
+    std::cout << "7-point stencil " << BENCH_GRID_EDGE << "^3: row-major " << row_major_rate << ", tiled "
+              << tiled_rate << " Melements/s" << std::endl;
+
+    return same_elements(row_major_dest_view, tiled_dest_view);
+}
+
+//---------------------------Plane sums--------------------------------------------
+
+// Sums every plane orthogonal to dim through a rank-reducing subview, tile by tile
+// for a tiled layout.
+template <class Layout>
+static uint64_t sum_planes(const TensorView<uint32_t, 3, Layout> &grid, size_t dim)
+{
+    uint64_t total = 0;
+    for (size_t position = 0; position < grid.extent(dim); ++position)
+    {
+        auto plane = grid.subview(dim, position);
+
+        uint64_t sum = 0;
+        for_each_index_blocked(plane, Layout::BLOCK, [&plane, &sum](const Array<size_t, 2> &index)
+        {
+            sum += plane[index];
+        });
+
+        total = total * 31 + sum;
+    }
+
+    return total;
+}
+
+static bool bench_planes()
+{
+    const Array<size_t, 3> EXTENTS = {BENCH_GRID_EDGE, BENCH_GRID_EDGE, BENCH_GRID_EDGE};
+    const size_t ELEMENTS          = BENCH_GRID_EDGE * BENCH_GRID_EDGE * BENCH_GRID_EDGE;
+
+    Vector<uint32_t> row_major = make_storage<LayoutRowMajor>(EXTENTS);
+    Vector<uint32_t> tiled     = make_storage<Tiled3D>(EXTENTS);
+
+    TensorView<uint32_t, 3, LayoutRowMajor> row_major_view(row_major, EXTENTS);
+    TensorView<uint32_t, 3, Tiled3D>        tiled_view    (tiled,     EXTENTS);
+
+    fill_pattern(row_major_view);
+    copy_layout(tiled_view, row_major_view);
+
+    bool passed = true;
+    for (size_t dim = 0; dim < 3; ++dim)
+    {
+        uint64_t row_major_sum = 0;
+        uint64_t tiled_sum     = 0;
+
+        double row_major_rate = measure(ELEMENTS, [&](){ row_major_sum = sum_planes(row_major_view, dim); });
+        double tiled_rate     = measure(ELEMENTS, [&](){ tiled_sum = sum_planes(tiled_view, dim); });
+
+        std::cout << "planes across dim " << dim << ": row-major " << row_major_rate << ", tiled " << tiled_rate
+                  << " Melements/s" << std::endl;
+
+        passed = (row_major_sum == tiled_sum) && passed;
+    }
+
+    return passed;
+}
+
+
+int main()
+{
+    std::cout << std::fixed << std::setprecision(1);
+
+    bool passed = true;
+
+    passed = bench_transpose() && passed;
+    passed = bench_stencil()   && passed;
+    passed = bench_planes()    && passed;
+
+    if (!passed)
+    {
+        std::cerr << "ERROR: row-major and tiled tensors gave different results" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -0,0 +1,501 @@
+#ifndef TENSOR_VIEW_HPP
+#define TENSOR_VIEW_HPP
+
+
+#include <algorithm>
+#include "array.hpp"
+#include "vector.hpp"
+
+
+//---------------------------Const section-----------------------------------------
+const size_t DEFAULT_COPY_BLOCK = 32;                                               // block edge for copies between untiled layouts
+
+
+//---------------------------Layouts-----------------------------------------------
+// A layout turns a multi-index into an offset in flat storage. Each one provides
+// Mapping<Rank> with operator() and required_span_size(), and BLOCK: the edge of the
+// blocks it is stored in (0 if it is not blocked).
+
+struct LayoutRowMajor
+{
+    static const size_t BLOCK = 0;
+
+    template <size_t Rank>
+    class Mapping
+    {
+    public:
+
+        constexpr Mapping() = default;
+
+        constexpr explicit Mapping(const Array<size_t, Rank> &extents)
+          : extents_(extents)
+        {
+            size_t stride = 1;
+            for (size_t dim = Rank; dim > 0; --dim)
+            {
+                strides_[dim - 1] = stride;
+                stride *= extents_[dim - 1];
+            }
+        }
+
+        constexpr size_t operator ()(const Array<size_t, Rank> &index) const
+        {
+            size_t offset = 0;
+            for (size_t dim = 0; dim < Rank; ++dim)
+            {
+                offset += index[dim] * strides_[dim];
+            }
+
+            return offset;
+        }
+
+        constexpr size_t required_span_size() const
+        {
+            return Rank == 0 ? 1 : strides_[0] * extents_[0];
+        }
+
+    private:
+
+        Array<size_t, Rank> extents_ = {};
+        Array<size_t, Rank> strides_ = {};
+    };
+};
+
+struct LayoutColMajor
+{
+    static const size_t BLOCK = 0;
+
+    template <size_t Rank>
+    class Mapping
+    {
+    public:
+
+        constexpr Mapping() = default;
+
+        constexpr explicit Mapping(const Array<size_t, Rank> &extents)
+          : extents_(extents)
+        {
+            size_t stride = 1;
+            for (size_t dim = 0; dim < Rank; ++dim)
+            {
+                strides_[dim] = stride;
+                stride *= extents_[dim];
+            }
+        }
+
+        constexpr size_t operator ()(const Array<size_t, Rank> &index) const
+        {
+            size_t offset = 0;
+            for (size_t dim = 0; dim < Rank; ++dim)
+            {
+                offset += index[dim] * strides_[dim];
+            }
+
+            return offset;
+        }
+
+        constexpr size_t required_span_size() const
+        {
+            return Rank == 0 ? 1 : strides_[Rank - 1] * extents_[Rank - 1];
+        }
+
+    private:
+
+        Array<size_t, Rank> extents_ = {};
+        Array<size_t, Rank> strides_ = {};
+    };
+};
+
+// Storage is split into TileSize^Rank blocks laid out row-major, and each block
+// is row-major inside. Extents are padded up to a multiple of TileSize.
+template <size_t TileSize>
+struct LayoutTiled
+{
+    static_assert(TileSize != 0, "tile size must not be zero");
+
+    static const size_t BLOCK = TileSize;
+
+    template <size_t Rank>
+    class Mapping
+    {
+    public:
+
+        constexpr Mapping() = default;
+
+        constexpr explicit Mapping(const Array<size_t, Rank> &extents)
+        {
+            size_t tile_stride = TILE_VOLUME;
+            for (size_t dim = Rank; dim > 0; --dim)
+            {
+                tile_strides_[dim - 1] = tile_stride;
+                tile_stride *= (extents[dim - 1] + TileSize - 1) / TileSize;
+            }
+
+            span_size_ = tile_stride;
+        }
+
+        // Only the offsets of whole tiles depend on the extents: the position inside
+        // a tile is built from compile-time strides, which for a power-of-two TileSize
+        // makes it shifts and masks, and the last dimension needs no multiply at all.
+        constexpr size_t operator ()(const Array<size_t, Rank> &index) const
+        {
+            size_t offset = 0;
+            for (size_t dim = 0; dim < Rank; ++dim)
+            {
+                offset += (index[dim] / TileSize) * tile_strides_[dim] + (index[dim] % TileSize) * inner_stride(dim);
+            }
+
+            return offset;
+        }
+
+        constexpr size_t required_span_size() const
+        {
+            return span_size_;
+        }
+
+    private:
+
+        static constexpr size_t inner_stride(size_t dim)
+        {
+            size_t stride = 1;
+            for (size_t next = dim + 1; next < Rank; ++next)
+            {
+                stride *= TileSize;
+            }
+
+            return stride;
+        }
+
+        static constexpr size_t TILE_VOLUME = Rank == 0 ? 1 : inner_stride(0) * TileSize;
+
+        Array<size_t, Rank> tile_strides_ = {};                                     // already multiplied by TILE_VOLUME
+
+        size_t span_size_ = TILE_VOLUME;
+    };
+};
+
+// One dimension of a tensor stored in Layout fixed at a position (a plane of a 3D
+// grid, a row of a matrix). The index is widened back to ParentRank and passed to
+// the parent mapping, so a slice of a tiled tensor still reads whole tiles.
+template <class Layout, size_t ParentRank>
+struct LayoutSlice
+{
+    static const size_t BLOCK = Layout::BLOCK;
+
+    using ParentMapping = typename Layout::template Mapping<ParentRank>;
+
+    template <size_t Rank>
+    class Mapping
+    {
+        static_assert(Rank + 1 == ParentRank, "a slice drops exactly one dimension");
+
+    public:
+
+        constexpr Mapping() = default;
+
+        // base is the parent index of the first element of the slice.
+        constexpr Mapping(const ParentMapping &parent, const Array<size_t, ParentRank> &base, size_t fixed_dim)
+          : parent_   (parent),
+            base_     (base),
+            fixed_dim_(fixed_dim)
+        {}
+
+        constexpr size_t operator ()(const Array<size_t, Rank> &index) const
+        {
+            Array<size_t, ParentRank> parent_index = base_;
+            for (size_t dim = 0; dim < Rank; ++dim)
+            {
+                parent_index[dim < fixed_dim_ ? dim : dim + 1] += index[dim];
+            }
+
+            return parent_(parent_index);
+        }
+
+        constexpr size_t required_span_size() const
+        {
+            return parent_.required_span_size();
+        }
+
+    private:
+
+        ParentMapping parent_;
+
+        Array<size_t, ParentRank> base_ = {};
+        size_t fixed_dim_ = 0;
+    };
+};
+
+
+//---------------------------Class TensorView--------------------------------------
+// Non-owning Rank-dimensional view over flat storage of a Vector or an Array.
+// Subviews keep the mapping of the whole tensor and only shift the origin,
+// so they work the same way for every layout; rank-reducing subviews wrap it
+// in LayoutSlice.
+template <class Type, size_t Rank, class Layout = LayoutRowMajor>
+class TensorView
+{
+public:
+
+    using Mapping = typename Layout::template Mapping<Rank>;
+
+//--------------------Constructors, destructors and =------------------------------
+    constexpr TensorView(Type *data, const Array<size_t, Rank> &extents)
+      : data_   (data),
+        mapping_(extents),
+        extents_(extents)
+    {}
+
+    // A view over storage with a ready mapping, for example a slice of another view.
+    constexpr TensorView(Type *data, const Mapping &mapping, const Array<size_t, Rank> &extents)
+      : data_   (data),
+        mapping_(mapping),
+        extents_(extents)
+    {}
+
+    template <class Element>
+    TensorView(Vector<Element> &storage, const Array<size_t, Rank> &extents)
+      : TensorView(storage.data(), extents)
+    {
+        check_storage(storage.size());
+    }
+
+    template <class Element, size_t Capacity>
+    TensorView(Array<Element, Capacity> &storage, const Array<size_t, Rank> &extents)
+      : TensorView(storage.data(), extents)
+    {
+        check_storage(Capacity);
+    }
+
+//---------------------------Size and shape----------------------------------------
+
+    constexpr size_t extent(const size_t dim) const
+    {
+        return extents_[dim];
+    }
+
+    constexpr const Array<size_t, Rank> &extents() const
+    {
+        return extents_;
+    }
+
+    constexpr size_t size() const
+    {
+        size_t result = 1;
+        for (size_t dim = 0; dim < Rank; ++dim)
+        {
+            result *= extents_[dim];
+        }
+
+        return result;
+    }
+
+    // Number of elements the whole (not sliced) tensor needs in storage.
+    constexpr size_t required_span_size() const
+    {
+        return mapping_.required_span_size();
+    }
+
+//-----------------------------Operating elements----------------------------------
+
+    template <class... Indices>
+    constexpr Type &operator ()(Indices... indices) const
+    {
+        static_assert(sizeof...(Indices) == Rank, "number of indices must match the tensor rank");
+
+        return this->operator[](Array<size_t, Rank>{static_cast<size_t> (indices)...});
+    }
+
+    constexpr Type &operator [](const Array<size_t, Rank> &index) const
+    {
+        Array<size_t, Rank> absolute = {};
+        for (size_t dim = 0; dim < Rank; ++dim)
+        {
+            assert(index[dim] < extents_[dim]);
+
+            absolute[dim] = origin_[dim] + index[dim];
+        }
+
+        return data_[mapping_(absolute)];
+    }
+
+    constexpr Type *data() const
+    {
+        return data_;
+    }
+
+    constexpr const Mapping &mapping() const
+    {
+        return mapping_;
+    }
+
+    // Index of the first element of the view in the whole tensor.
+    constexpr const Array<size_t, Rank> &origin() const
+    {
+        return origin_;
+    }
+
+//---------------------------Slicing-----------------------------------------------
+
+    // Elements with index[dim] in [from[dim], to[dim]) for every dim.
+    TensorView subview(const Array<size_t, Rank> &from, const Array<size_t, Rank> &to) const
+    {
+        TensorView result = *this;
+        for (size_t dim = 0; dim < Rank; ++dim)
+        {
+            if ((from[dim] > to[dim]) || (to[dim] > extents_[dim]))
+            {
+                REPORT_EVENT(DiagCode::SUBVIEW_OUT_OF_BOUNDS, dim, from[dim], to[dim]);
+
+                throw std::out_of_range("ERROR: subview out of bounds");
+            }
+
+            result.origin_ [dim] = origin_[dim] + from[dim];
+            result.extents_[dim] = to[dim] - from[dim];
+        }
+
+        return result;
+    }
+
+    // Elements with index[dim] == position as a view of rank Rank - 1.
+    TensorView<Type, Rank - 1, LayoutSlice<Layout, Rank>> subview(const size_t dim, const size_t position) const
+    {
+        static_assert(Rank > 0, "a tensor of rank 0 has no dimension to fix");
+
+        if ((dim >= Rank) || (position >= extents_[dim]))
+        {
+            REPORT_EVENT(DiagCode::SUBVIEW_OUT_OF_BOUNDS, dim, position, position + 1);
+
+            throw std::out_of_range("ERROR: subview out of bounds");
+        }
+
+        Array<size_t, Rank - 1> extents = {};
+        for (size_t from = 0, to = 0; from < Rank; ++from)
+        {
+            if (from != dim)
+            {
+                extents[to++] = extents_[from];
+            }
+        }
+
+        Array<size_t, Rank> base = origin_;
+        base[dim] += position;
+
+        using SliceMapping = typename LayoutSlice<Layout, Rank>::template Mapping<Rank - 1>;
+
+        return TensorView<Type, Rank - 1, LayoutSlice<Layout, Rank>>(data_, SliceMapping(mapping_, base, dim), extents);
+    }
+
+private:
+//--------------------------Utility functions--------------------------------------
+
+    void check_storage(size_t storage_size) const
+    {
+        if (storage_size < mapping_.required_span_size())
+        {
+            REPORT_EVENT(DiagCode::STORAGE_TOO_SMALL, storage_size, mapping_.required_span_size());
+
+            throw std::out_of_range("ERROR: storage is too small for the tensor");
+        }
+    }
+
+private:
+//----------------------------Variables--------------------------------------------
+
+    Type *data_ = nullptr;
+
+    Mapping mapping_;
+
+    Array<size_t, Rank> extents_ = {};
+    Array<size_t, Rank> origin_  = {};
+};
+
+
+//---------------------------Traversal---------------------------------------------
+
+// Moves index to the next multi-index inside [from, to) in row-major order.
+// Returns false after the last one.
+template <size_t Rank>
+constexpr bool next_index(Array<size_t, Rank> &index, const Array<size_t, Rank> &from, const Array<size_t, Rank> &to)
+{
+    for (size_t dim = Rank; dim > 0; --dim)
+    {
+        if (++index[dim - 1] < to[dim - 1])
+        {
+            return true;
+        }
+
+        index[dim - 1] = from[dim - 1];
+    }
+
+    return false;
+}
+
+// Calls function(index) for every index of the view, block by block: with block == 0
+// the traversal is plain row-major, otherwise it walks block^Rank cubes one at a time.
+// Cubes are aligned to the whole tensor, not to the view, so with the BLOCK of a tiled
+// layout every cube is one tile (cut at the edges of the view).
+template <class Type, size_t Rank, class Layout, class Function>
+void for_each_index_blocked(const TensorView<Type, Rank, Layout> &view, size_t block, Function function)
+{
+    if (view.size() == 0)
+    {
+        return;
+    }
+
+    Array<size_t, Rank> zero     = {};
+    Array<size_t, Rank> extents  = view.extents();
+    Array<size_t, Rank> shift    = {};                                              // view origin inside its first cube
+    Array<size_t, Rank> block_to = {};
+    for (size_t dim = 0; dim < Rank; ++dim)
+    {
+        shift   [dim] = block == 0 ? 0 : view.origin()[dim] % block;
+        block_to[dim] = block == 0 ? 1 : (shift[dim] + extents[dim] + block - 1) / block;
+    }
+
+    Array<size_t, Rank> block_index = {};
+    do
+    {
+        Array<size_t, Rank> from = {};
+        Array<size_t, Rank> to   = {};
+        for (size_t dim = 0; dim < Rank; ++dim)
+        {
+            from[dim] = block == 0 ? 0            : std::max(block_index[dim] * block, shift[dim]) - shift[dim];
+            to  [dim] = block == 0 ? extents[dim] : std::min((block_index[dim] + 1) * block - shift[dim], extents[dim]);
+        }
+
+        Array<size_t, Rank> index = from;
+        do
+        {
+            function(index);
+        }
+        while (next_index(index, from, to));
+    }
+    while (next_index(block_index, zero, block_to));
+}
+
+// Copies src into dst converting between layouts (for example row-major into tiled).
+// The traversal goes block by block, so both sides stay in cache whatever their layouts are.
+template <class DestType, class SrcType, size_t Rank, class DestLayout, class SrcLayout>
+void copy_layout(const TensorView<DestType, Rank, DestLayout> &dest, const TensorView<SrcType, Rank, SrcLayout> &src)
+{
+    for (size_t dim = 0; dim < Rank; ++dim)
+    {
+        if (dest.extent(dim) != src.extent(dim))
+        {
+            REPORT_EVENT(DiagCode::SHAPE_MISMATCH, dim, dest.extent(dim), src.extent(dim));
+
+            throw std::length_error("ERROR: copying between tensors of different shapes");
+        }
+    }
+
+    size_t block = DestLayout::BLOCK != 0 ? DestLayout::BLOCK :
+                   SrcLayout::BLOCK  != 0 ? SrcLayout::BLOCK  : DEFAULT_COPY_BLOCK;
+
+    for_each_index_blocked(dest, block, [&dest, &src](const Array<size_t, Rank> &index)
+    {
+        dest[index] = src[index];
+    });
+}
+
+
+#endif
@@ -1,3 +1,14 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "array.hpp"
 #include "vector.hpp"
 
 
@@ -32,8 +43,791 @@ void dump_elem(const TestClass &value)
 }
 
 
+//---------------------------Compile-time checks-----------------------------------
+// Vector allocates transiently inside a constant evaluation: a table is built with
+// it, copied into an Array and only the Array is kept (in .rodata, no startup cost).
+
+constexpr Array<int, 8> first_primes_table()
+{
+    Vector<int> primes;
+    for (int candidate = 2; primes.size() < 8; ++candidate)
+    {
+        bool is_prime = true;
+        for (int prime : primes)
+        {
+            if (candidate % prime == 0)
+            {
+                is_prime = false;
+            }
+        }
+
+        if (is_prime)
+        {
+            primes.push_back(candidate);
+        }
+    }
+
+    Array<int, 8> table{};
+    for (size_t index = 0; index < table.size(); ++index)
+    {
+        table[index] = primes[index];
+    }
+
+    return table;
+}
+
+constexpr Array<int, 8> FIRST_PRIMES = first_primes_table();
+
+static_assert(FIRST_PRIMES == Array<int, 8>{2, 3, 5, 7, 11, 13, 17, 19});
+
+constexpr bool edits_in_constant_evaluation()
+{
+    Vector<int> vector;
+    for (int value = 0; value < 10; ++value)
+    {
+        vector.push_back(value);
+    }
+
+    vector.erase(0);                                                                // 1 2 ... 9
+    vector.insert(4, 100);                                                          // 1 2 3 4 100 5 ... 9
+    vector.resize(12, -1);
+
+    Vector<int> copy = vector;
+    copy.pop_back();
+
+    Vector<int> moved = std::move(copy);
+    moved.shrink_to_fit();
+
+    return (vector.size() == 12) && (vector[0] == 1) && (vector[4] == 100) && (vector[11] == -1) &&
+           (moved.size() == 11) && (moved.capacity() == 11) && (copy.empty()) && (moved < vector);
+}
+
+static_assert(edits_in_constant_evaluation());
+
+constexpr bool bits_in_constant_evaluation()
+{
+    BitVector bits(100, false);
+    bits[3]  = true;
+    bits[97] = true;
+    bits.push_back(true);
+
+    return (bits.size() == 101) && (bits.count() == 3) && (bits.find_next(3) == 97);
+}
+
+static_assert(bits_in_constant_evaluation());
+
+
+//---------------------------Allocation counting-----------------------------------
+// Every buffer a Vector takes from std::allocator goes through this operator new,
+// including the snapshots taken for the strong exception guarantee, so the harness
+// counts the allocations an operation really makes.
+
+static std::atomic<size_t> allocation_count(0);
+
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+// All kept out of line: inlined into std::string, malloc() and free() would be paired
+// with the builtin operators and trip -Wmismatched-new-delete.
+__attribute__((noinline)) void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+// The std::vector model takes memory from malloc, so it does not add to the count.
+template <class Type>
+struct UncountedAllocator
+{
+    using value_type = Type;
+
+    UncountedAllocator() = default;
+
+    template <class Other>
+    UncountedAllocator(const UncountedAllocator<Other> &)
+    {}
+
+    Type *allocate(size_t quantity)
+    {
+        void *memory = std::malloc(quantity * sizeof(Type));
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        return static_cast<Type *> (memory);
+    }
+
+    void deallocate(Type *data, size_t)
+    {
+        std::free(data);
+    }
+
+    friend bool operator ==(const UncountedAllocator &, const UncountedAllocator &)
+    {
+        return true;
+    }
+};
+
+using Model = std::vector<int, UncountedAllocator<int>>;
+
+
+//---------------------------Complexity contracts----------------------------------
+// A counting element and a differential run against std::vector: every operation
+// must leave the same elements and spend exactly the element operations and
+// allocations of its path, so an O(n) slip in an O(1) path makes the program fail.
+
+struct OperationCounters
+{
+    size_t constructions_ = 0;                                                      // from a value or default
+    size_t copies_        = 0;                                                      // copy constructions and copy assignments
+    size_t moves_         = 0;                                                      // move constructions and move assignments
+    size_t assignments_   = 0;
+    size_t destructions_  = 0;
+    size_t allocations_   = 0;                                                      // taken from allocation_count
+};
+
+static OperationCounters counters;
+static size_t live_elements = 0;                                                    // constructed and not yet destroyed
+
+const size_t UNLIMITED_MOVES = SIZE_MAX;
+
+static size_t moves_left = UNLIMITED_MOVES;                                         // moves of a throwing element before one throws
+
+// With NothrowMoves == false the moves are not noexcept, so Vector relocates such
+// elements by copying and shifts them under a snapshot; they throw once moves_left
+// runs out, which lets the harness fail an operation halfway.
+template <bool NothrowMoves>
+class CountedElement
+{
+public:
+    CountedElement()
+    {
+        ++counters.constructions_;
+        ++live_elements;
+    }
+
+    CountedElement(int value)
+      : value_(value)
+    {
+        ++counters.constructions_;
+        ++live_elements;
+    }
+
+    CountedElement(const CountedElement &other)
+      : value_(other.value_)
+    {
+        ++counters.copies_;
+        ++live_elements;
+    }
+
+    CountedElement(CountedElement &&other) noexcept(NothrowMoves)
+      : value_(other.value_)
+    {
+        count_move();
+        ++live_elements;                                                            // not reached if the move throws
+    }
+
+    CountedElement &operator =(const CountedElement &other)
+    {
+        value_ = other.value_;
+        ++counters.copies_;
+        ++counters.assignments_;
+
+        return *this;
+    }
+
+    CountedElement &operator =(CountedElement &&other) noexcept(NothrowMoves)
+    {
+        count_move();
+        value_ = other.value_;
+        ++counters.assignments_;
+
+        return *this;
+    }
+
+    ~CountedElement()
+    {
+        ++counters.destructions_;
+        --live_elements;
+    }
+
+    int get_value() const
+    {
+        return value_;
+    }
+
+private:
+
+    static void count_move()
+    {
+        if constexpr (!NothrowMoves)
+        {
+            if (moves_left == 0)
+            {
+                throw std::runtime_error("ERROR: element move failed");
+            }
+
+            if (moves_left != UNLIMITED_MOVES)
+            {
+                --moves_left;
+            }
+        }
+
+        ++counters.moves_;
+    }
+
+    int value_ = 0;
+};
+
+using NothrowElement  = CountedElement<true>;
+using ThrowingElement = CountedElement<false>;
+
+struct OperationBudget
+{
+    size_t constructions_ = 0;
+    size_t copies_        = 0;
+    size_t moves_         = 0;
+    size_t assignments_   = 0;
+    size_t allocations_   = 0;
+};
+
+static OperationBudget operator +(const OperationBudget &left, const OperationBudget &right)
+{
+    return {left.constructions_ + right.constructions_, left.copies_ + right.copies_, left.moves_ + right.moves_,
+            left.assignments_ + right.assignments_, left.allocations_ + right.allocations_};
+}
+
+// With exact == false the budget is an upper bound, otherwise every count must match it.
+static bool check_budget(const char *operation, const OperationCounters &spent, const OperationBudget &budget, bool exact = false)
+{
+    bool within = (spent.constructions_ <= budget.constructions_) && (spent.copies_ <= budget.copies_) &&
+                  (spent.moves_ <= budget.moves_) && (spent.assignments_ <= budget.assignments_) &&
+                  (spent.allocations_ <= budget.allocations_);
+
+    bool matches = (spent.constructions_ == budget.constructions_) && (spent.copies_ == budget.copies_) &&
+                   (spent.moves_ == budget.moves_) && (spent.assignments_ == budget.assignments_) &&
+                   (spent.allocations_ == budget.allocations_);
+
+    if (exact ? matches : within)
+    {
+        return true;
+    }
+
+    std::cerr << "ERROR: " << operation << (exact ? " does not match its counts: " : " is over budget: ")
+              << spent.constructions_ << "/" << budget.constructions_ << " constructions, "
+              << spent.copies_ << "/" << budget.copies_ << " copies, "
+              << spent.moves_ << "/" << budget.moves_ << " moves, "
+              << spent.assignments_ << "/" << budget.assignments_ << " assignments, "
+              << spent.allocations_ << "/" << budget.allocations_ << " allocations" << std::endl;
+
+    return false;
+}
+
+template <class Element>
+static bool same_elements(const Vector<Element> &vector, const Model &model)
+{
+    if (vector.size() != model.size())
+    {
+        return false;
+    }
+
+    for (size_t index = 0; index < model.size(); ++index)
+    {
+        if (vector[index].get_value() != model[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Every push_back copies its value once; relocations touch each element once per
+// doubling, which is at most 2 per push_back on average: moves for a nothrow element,
+// copies for a throwing one.
+template <class Element>
+static bool check_push_back_amortized(size_t operation_count)
+{
+    const bool NOTHROW = std::is_nothrow_move_constructible_v<Element>;
+
+    Vector<Element> vector;
+    Element value(1);
+
+    counters = OperationCounters();
+    size_t allocations = allocation_count;
+    for (size_t operation = 0; operation < operation_count; ++operation)
+    {
+        vector.push_back(value);
+    }
+    counters.allocations_ = allocation_count - allocations;
+
+    size_t doublings = 0;
+    while ((static_cast<size_t> (1) << doublings) <= operation_count)
+    {
+        ++doublings;
+    }
+
+    OperationBudget budget = {0, operation_count, 2 * operation_count, 0, doublings + 1};
+    if (!NOTHROW)
+    {
+        budget = {0, 3 * operation_count, 0, 0, doublings + 1};
+    }
+
+    return check_budget("push_back (amortized)", counters, budget);
+}
+
+// Counts are exact for the path each operation has to take. A throwing element adds
+// the snapshot that shifting insert and erase take (one allocation and a copy of every
+// element) and copies in place of relocating moves. Whether a shrinking operation
+// relocates is up to the shrink policy, so that is read from the capacity afterwards.
+template <class Element>
+static bool check_random_operations(size_t operation_count, unsigned seed)
+{
+    const bool NOTHROW = std::is_nothrow_move_constructible_v<Element>;
+
+    std::mt19937 generator(seed);
+
+    Vector<Element> vector;
+    Model model;
+
+    vector.set_shrink_policy(DEFAULT_SHRINK_POLICY);
+
+    // Moving count elements into a new buffer (none is allocated when shrinking to nothing).
+    auto relocation = [NOTHROW](size_t count, bool allocates)
+    {
+        OperationBudget budget = NOTHROW ? OperationBudget{0, 0, count, 0, 0} : OperationBudget{0, count, 0, 0, 0};
+        budget.allocations_    = allocates ? 1 : 0;
+
+        return budget;
+    };
+
+    for (size_t operation = 0; operation < operation_count; ++operation)
+    {
+        int value        = static_cast<int> (generator() % 1000);
+        size_t size      = model.size();
+        size_t capacity  = vector.capacity();
+        size_t index     = size == 0 ? 0 : generator() % (size + 1);
+        const char *name = nullptr;
+
+        Element element(value);
+        OperationBudget budget;
+
+        OperationBudget snapshot = NOTHROW ? OperationBudget{} : OperationBudget{0, size, 0, 0, 1};
+
+        counters = OperationCounters();
+        size_t allocations = allocation_count;
+        switch (generator() % 8)
+        {
+            case 0:
+            case 1:
+            case 2:
+                index = size;
+                [[fallthrough]];
+
+            case 3:
+                name = index == size ? "push_back" : "insert";
+
+                if (size == capacity)
+                {
+                    budget = OperationBudget{0, 1, 0, 0, 0} + relocation(size, true);
+                }
+                else if (index == size)
+                {
+                    budget = {0, 1, 0, 0, 0};
+                }
+                else
+                {
+                    budget = snapshot + OperationBudget{0, 1, size - index + 1, size - index, 0};
+                }
+
+                if (index == size)
+                {
+                    vector.push_back(element);
+                }
+                else
+                {
+                    vector.insert(index, element);
+                }
+                model.insert(model.begin() + static_cast<ptrdiff_t> (index), value);
+                break;
+
+            case 4:
+                if (index == size)
+                {
+                    continue;
+                }
+
+                name   = "erase";
+                budget = snapshot + OperationBudget{0, 0, size - index - 1, size - index - 1, 0};
+                vector.erase(index);
+                model.erase(model.begin() + static_cast<ptrdiff_t> (index));
+                break;
+
+            case 5:
+            case 6:
+                name = "pop_back";
+                vector.pop_back();
+                if (size != 0)
+                {
+                    model.pop_back();
+                }
+                break;
+
+            default:
+            {
+                size_t new_size = size / 2 + generator() % (size + 8);
+                size_t added    = new_size > size ? new_size - size : 0;
+
+                name   = "resize";
+                budget = {0, added, 0, 0, 0};
+                if (new_size > capacity)
+                {
+                    budget = budget + relocation(size, true);
+                }
+                vector.resize(new_size, element);
+                model.resize(new_size, value);
+                break;
+            }
+        }
+
+        counters.allocations_ = allocation_count - allocations;
+
+        if (vector.capacity() < capacity)                                           // shrunk by the policy
+        {
+            budget = budget + relocation(vector.size(), vector.capacity() != 0);
+        }
+
+        if (!check_budget(name, counters, budget, true))
+        {
+            return false;
+        }
+
+        if (!same_elements(vector, model))
+        {
+            std::cerr << "ERROR: " << name << " left different elements than std::vector" << std::endl;
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// A move that throws in the middle of insert or erase must leave the vector as it
+// was, and no element it built on the way may be left alive outside of it; the
+// failures are expected, so their events go to a NullDiagnosticsSink.
+static bool check_strong_guarantee(size_t size)
+{
+    NullDiagnosticsSink null_sink;
+    DiagnosticsSink *previous_sink = set_diagnostics_sink(&null_sink);
+
+    bool passed     = true;
+    size_t failures = 0;
+
+    ThrowingElement element(-1);
+
+    for (size_t allowed_moves = 0; allowed_moves <= size; ++allowed_moves)
+    {
+        for (bool inserting : {true, false})
+        {
+            size_t live_before = live_elements;
+
+            Vector<ThrowingElement> vector;
+            Model model;
+
+            vector.reserve(size + 1);                                               // insert shifts instead of reallocating
+            for (size_t index = 0; index < size; ++index)
+            {
+                vector.push_back(ThrowingElement(static_cast<int> (index)));
+                model.push_back(static_cast<int> (index));
+            }
+
+            moves_left = allowed_moves;
+            try
+            {
+                if (inserting)
+                {
+                    vector.insert(1, element);
+                    model.insert(model.begin() + 1, -1);
+                }
+                else
+                {
+                    vector.erase(1);
+                    model.erase(model.begin() + 1);
+                }
+            }
+            catch (const std::runtime_error &)
+            {
+                ++failures;
+            }
+            moves_left = UNLIMITED_MOVES;
+
+            if (!same_elements(vector, model))
+            {
+                std::cerr << "ERROR: failed " << (inserting ? "insert" : "erase") << " after " << allowed_moves
+                          << " moves changed the vector" << std::endl;
+
+                passed = false;
+            }
+
+            if (live_elements != live_before + vector.size())
+            {
+                std::cerr << "ERROR: " << (inserting ? "insert" : "erase") << " failing after " << allowed_moves
+                          << " moves leaked " << live_elements - live_before - vector.size() << " elements" << std::endl;
+
+                passed = false;
+            }
+        }
+    }
+
+    set_diagnostics_sink(previous_sink);
+
+    if (failures == 0)
+    {
+        std::cerr << "ERROR: no move failed, the snapshot path was not exercised" << std::endl;
+
+        return false;
+    }
+
+    return passed;
+}
+
+static bool check_complexity_contracts()
+{
+    const size_t PUSH_BACK_COUNT       = 1 << 16;
+    const size_t RANDOM_OPS_COUNT      = 20000;
+    const size_t STRONG_GUARANTEE_SIZE = 16;
+    const unsigned SEEDS[]             = {1, 2, 3};
+
+    bool passed = check_push_back_amortized<NothrowElement>(PUSH_BACK_COUNT);
+    passed = check_push_back_amortized<ThrowingElement>(PUSH_BACK_COUNT) && passed;
+
+    for (unsigned seed : SEEDS)
+    {
+        passed = check_random_operations<NothrowElement>(RANDOM_OPS_COUNT, seed) && passed;
+        passed = check_random_operations<ThrowingElement>(RANDOM_OPS_COUNT, seed) && passed;
+    }
+
+    passed = check_strong_guarantee(STRONG_GUARANTEE_SIZE) && passed;
+
+    return passed;
+}
+
+
+//---------------------------Memory reclamation------------------------------------
+
+// A scratch vector cleared and refilled to capacity every round must keep its
+// buffer, while one that is refilled to a small fraction of it gives memory back.
+static bool check_shrink_hysteresis()
+{
+    const size_t FULL_SIZE  = 100000;
+    const size_t SMALL_SIZE = 10;
+    const size_t ROUNDS     = 64;
+
+    Vector<int> vector;
+    vector.set_shrink_policy(DEFAULT_SHRINK_POLICY);
+
+    size_t allocations = 0;
+    for (size_t round = 0; round < ROUNDS; ++round)
+    {
+        if (round == 1)
+        {
+            allocations = allocation_count;                                         // the first round grows the buffer
+        }
+
+        for (size_t index = 0; index < FULL_SIZE; ++index)
+        {
+            vector.push_back(static_cast<int> (index));
+        }
+
+        vector.clear();
+    }
+
+    if (allocation_count != allocations)
+    {
+        std::cerr << "ERROR: clearing and refilling to capacity freed the buffer "
+                  << allocation_count - allocations << " times" << std::endl;
+
+        return false;
+    }
+
+    size_t full_capacity = vector.capacity();
+    for (size_t round = 0; round < DEFAULT_SHRINK_POLICY.patience_; ++round)
+    {
+        for (size_t index = 0; index < SMALL_SIZE; ++index)
+        {
+            vector.push_back(static_cast<int> (index));
+        }
+
+        vector.clear();
+    }
+
+    if (vector.capacity() >= full_capacity)
+    {
+        std::cerr << "ERROR: refilling to " << SMALL_SIZE << " elements kept a capacity of "
+                  << vector.capacity() << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+static bool check_memory_reclamation()
+{
+    return check_shrink_hysteresis();
+}
+
+
+//---------------------------Learned capacity--------------------------------------
+// Vectors built at one CAPACITY_SITE must stop growing step by step once the site
+// has learned their size, the hint must follow a change of sizes within two windows,
+// and exported hints must have distinct names.
+
+struct LearnedFill
+{
+    size_t reserved_    = 0;                                                        // capacity right after construction
+    size_t allocations_ = 0;
+};
+
+static Vector<int> learning_vector()
+{
+    return Vector<int>(CAPACITY_SITE);                                              // guaranteed elision: no move reports a size
+}
+
+static LearnedFill fill_learning_vector(size_t size)
+{
+    LearnedFill fill;
+
+    size_t allocations = allocation_count;
+    {
+        Vector<int> vector = learning_vector();
+        fill.reserved_ = vector.capacity();
+
+        for (size_t index = 0; index < size; ++index)
+        {
+            vector.push_back(static_cast<int> (index));
+        }
+    }
+    fill.allocations_ = allocation_count - allocations;
+
+    return fill;
+}
+
+static size_t fill_plain_vector(size_t size)
+{
+    size_t allocations = allocation_count;
+    {
+        Vector<int> vector;
+        for (size_t index = 0; index < size; ++index)
+        {
+            vector.push_back(static_cast<int> (index));
+        }
+    }
+
+    return allocation_count - allocations;
+}
+
+static bool check_capacity_hints()
+{
+    const size_t LARGE_SIZE = 1000;
+    const size_t SMALL_SIZE = 10;
+    const size_t ROUNDS     = 4 * CAPACITY_HINT_WINDOW;
+
+    bool passed = true;
+
+    size_t plain_allocations   = fill_plain_vector(LARGE_SIZE);
+    size_t learned_allocations = 0;
+    for (size_t round = 0; round < ROUNDS; ++round)
+    {
+        learned_allocations = fill_learning_vector(LARGE_SIZE).allocations_;
+    }
+
+    if (learned_allocations >= plain_allocations)
+    {
+        std::cerr << "ERROR: a vector from a learned site took " << learned_allocations << " allocations, a plain one "
+                  << plain_allocations << std::endl;
+
+        passed = false;
+    }
+
+    size_t rounds_to_adapt = 0;
+    while ((rounds_to_adapt <= 2 * CAPACITY_HINT_WINDOW) &&
+           (fill_learning_vector(SMALL_SIZE).reserved_ > calculate_enough_capacity(SMALL_SIZE)))
+    {
+        ++rounds_to_adapt;
+    }
+
+    if (rounds_to_adapt > 2 * CAPACITY_HINT_WINDOW)
+    {
+        std::cerr << "ERROR: the hint did not follow sizes from " << LARGE_SIZE << " down to " << SMALL_SIZE
+                  << " within " << 2 * CAPACITY_HINT_WINDOW << " samples" << std::endl;
+
+        passed = false;
+    }
+
+    std::ostringstream exported;
+    export_capacity_hints(exported);
+
+    const std::string SITE_NAME = "const size_t RESERVE_HINT_vector_learning_vector_";  // file stem, function, line
+
+    std::set<std::string> names;
+    bool site_named = false;
+
+    std::istringstream lines(exported.str());
+    for (std::string line; std::getline(lines, line);)
+    {
+        std::string name = line.substr(0, line.find(" = "));
+        if (!names.insert(name).second)
+        {
+            std::cerr << "ERROR: exported hint name repeats: " << name << std::endl;
+
+            passed = false;
+        }
+
+        site_named = site_named || (name.compare(0, SITE_NAME.size(), SITE_NAME) == 0);
+    }
+
+    if (!site_named)
+    {
+        std::cerr << "ERROR: exported hints do not name the learning site:\n" << exported.str();
+
+        passed = false;
+    }
+
+    std::cout << "learned capacity: " << learned_allocations << " allocations per " << LARGE_SIZE << " push_backs, "
+              << plain_allocations << " without a site; the hint followed a drop to " << SMALL_SIZE << " elements in "
+              << rounds_to_adapt << " samples" << std::endl;
+
+    return passed;
+}
+
+
 int main()
 {
+    bool passed = check_complexity_contracts();
+    passed = check_memory_reclamation() && passed;
+    passed = check_capacity_hints() && passed;
+
+    if (!passed)
+    {
+        return EXIT_FAILURE;
+    }
 
     return 0;
-}
+}
\ No newline at end of file
@@ -2,13 +2,22 @@
 #define VECTOR_HPP
 
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <memory>
 #include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "capacity_hints.hpp"
+#include "deferred_reclaimer.hpp"
+#include "diagnostics.hpp"
 #include "location.hpp"
+#include "reclaim_registry.hpp"
 
 
-//---------------------------Defines section---------------------------------------                                                
+//---------------------------Defines section---------------------------------------
 //---------------------Exception warranties section--------------------------------
 #define STRICT_EXCEPTION_WARRANTY
 
@@ -16,13 +25,22 @@
 #ifdef STRICT_EXCEPTION_WARRANTY
 #define IF_STRICT_EXCEPTION_WARRANTY(code) code
 #else
-#define IF_STRICT_EXCEPTION_WARRANTY(code) 
+#define IF_STRICT_EXCEPTION_WARRANTY(code)
 #endif
 
 #ifdef BASE_EXCEPTION_WARRANTY
 #define IF_BASE_EXCEPTION_WARRANTY(code) code
 #else
-#define IF_BASE_EXCEPTION_WARRANTY(code) 
+#define IF_BASE_EXCEPTION_WARRANTY(code)
+#endif
+//---------------------Release latency section-------------------------------------
+//#define MEASURE_RELEASE_LATENCY
+
+
+#ifdef MEASURE_RELEASE_LATENCY
+#define IF_MEASURE_RELEASE_LATENCY(code) code
+#else
+#define IF_MEASURE_RELEASE_LATENCY(code)
 #endif
 //---------------------------------------------------------------------------------
 #define TRY_CATCH_BLOCK_STRICT_EXCEPTION_WARRANTY(try_section, catch_section)  IF_STRICT_EXCEPTION_WARRANTY(Vector saved_copy = *this;)  \
@@ -34,90 +52,235 @@
                                                                                {                                                         \
                                                                                     catch_section                                        \
                                                                                                                                          \
+                                                                                    IF_STRICT_EXCEPTION_WARRANTY(this->swap(saved_copy);)\
+                                                                                    IF_BASE_EXCEPTION_WARRANTY(~Vector();)               \
+                                                                                                                                         \
                                                                                     throw;                                               \
-                                                                               }                                                         \
-                                                                               IF_STRICT_EXCEPTION_WARRANTY(*this = saved_copy;)         \
-                                                                               IF_BASE_EXCEPTION_WARRANTY(~Vector();)
+                                                                               }
 //---------------------------Const section-----------------------------------------
-const char *UNINIT_PTR  = reinterpret_cast<const char *> (0xDEADBEEF);
-const char *DESTR_PTR   = reinterpret_cast<const char *> (0xBAADF00D);
-const char *INVALID_PTR = reinterpret_cast<const char *> (0xDEADDEAD);
+// Poison values are only written outside of constant evaluation: reinterpret_cast
+// is not allowed there, so compile-time vectors use nullptr for both states.
+const char *const DESTR_PTR   = reinterpret_cast<const char *> (0xBAADF00D);
+const char *const INVALID_PTR = reinterpret_cast<const char *> (0xDEADDEAD);
 const size_t POISONED_SIZE_T = 0xAB0BAC0C;
 
 const size_t DEFAULT_CAPACITY_MULTIPLIER = 2;
-const size_t VECTOR_MAX_CAPACITY         = 1024;
+
+// Elements, not bytes. It used to be 1024, which made the container a toy: sorting,
+// flat sets and the benchmarks need millions of elements. 2^32 still catches sizes
+// computed from a wrapped subtraction before they reach the allocator.
+const size_t VECTOR_MAX_CAPACITY         = static_cast<size_t> (1) << 32;
+
+
+//---------------------------Shrink policy-----------------------------------------
+// Capacity is given back after patience_ shrinking operations in a row (erase, pop_back,
+// resize down, clear) find that the vector stayed below capacity / ratio_ since the
+// previous one, so a vector cleared and refilled to capacity keeps its buffer.
+// ratio_ == 0 disables it.
+struct ShrinkPolicy
+{
+    size_t ratio_    = 0;
+    size_t patience_ = 0;
+};
+
+constexpr ShrinkPolicy NO_SHRINK_POLICY      = {};
+constexpr ShrinkPolicy DEFAULT_SHRINK_POLICY = {4, 16};
+
+
+//---------------------------Opt-in state------------------------------------------
+// State of features only some vectors turn on lives in a block allocated by the
+// first call that needs it, so a plain Vector is four words. Functions from other
+// translation units are only reached through the pointers set by those calls:
+// see README.md for which .cpp files a program has to link.
+struct VectorOptions
+{
+    ShrinkPolicy shrink_policy_ = NO_SHRINK_POLICY;
+    size_t low_usage_streak_    = 0;
+    size_t peak_size_           = 0;                                                // largest size since the last shrinking operation
+
+    void (*unregister_)(void *object)     = nullptr;                                // registered for reclaim()
+    bool (*defer_)(const ReclaimJob &job) = nullptr;                                // deferred release mode
+
+    CapacitySite *capacity_site_                          = nullptr;
+    void (*record_size_)(CapacitySite *site, size_t size) = nullptr;
+    bool size_recorded_                                   = false;
+};
+
+
+//---------------------------Growth policy-----------------------------------------
+// Smallest power of two strictly greater than required_size, clamped by VECTOR_MAX_CAPACITY.
+constexpr size_t calculate_enough_capacity(size_t required_size)
+{
+    size_t capacity = 1;
+
+    for (int base = 32; base > 0; base /= 2)
+    {
+        if (required_size >= (capacity << base))
+        {
+            capacity <<= base;
+        }
+    }
+
+    capacity <<= 1;
+
+    if (capacity > VECTOR_MAX_CAPACITY)
+    {
+        capacity = required_size > VECTOR_MAX_CAPACITY ? required_size : VECTOR_MAX_CAPACITY;
+    }
+
+    return capacity;
+}
 
 
 //---------------------------Class Vector------------------------------------------
+// Storage goes through std::allocator, std::construct_at and std::destroy_at, so
+// a Vector can be used (and must be freed) inside a single constant evaluation.
 template <class Type>
 class Vector
 {
+    // Such elements can be shifted without a snapshot: nothing can fail halfway.
+    static constexpr bool IS_NOTHROW_MOVABLE = std::is_nothrow_move_constructible_v<Type> &&
+                                               std::is_nothrow_move_assignable_v<Type>;
+
 public:
 //--------------------Constructors, destructors and =------------------------------
-    Vector()
+    constexpr Vector()
       : capacity_(0),
         size_    (0),
-        data_    (const_cast<char *> (UNINIT_PTR))
+        data_    (nullptr)
     {}
 
-    Vector(const size_t reserved_size, const Type &value = Type())
+    constexpr Vector(const size_t reserved_size, const Type &value = Type())
       : Vector()
     {
         if (reserved_size != 0)
         {
+            try
+            {
+                data_ = allocate_data(calculate_enough_capacity(reserved_size));
+            }
+            catch (...)
+            {
+                REPORT_EVENT(DiagCode::NOT_ALLOCATED, calculate_enough_capacity(reserved_size));
+                destroy_fields();
+
+                throw;
+            }
             capacity_ = calculate_enough_capacity(reserved_size);
+
             try
             {
-                data_ = new char[capacity_ * sizeof(Type)];
+                init_elements(0, reserved_size, value);
             }
             catch (...)
             {
-                std::cerr << "ERROR: vector data was not allocated" << std::endl;
+                release_data(data_, 0, capacity_);
                 destroy_fields();
 
                 throw;
             }
-            
-            init_elements(0, reserved_size, value);
 
             size_ = reserved_size;
         }
     }
 
-    ~Vector()
+    // Learns the capacity at site, written as Vector<Type> vector(CAPACITY_SITE): final
+    // sizes of vectors built there are recorded (see capacity_hints.hpp) and later
+    // ones reserve a typical size up front.
+    explicit Vector(CapacitySiteRef site)
+      : Vector()
     {
-        destroy_existing_elems(0, size_);
-        
-        if ((data_is_valid()) && (data_ != const_cast<char *> (UNINIT_PTR)))
+        if (site.site_ == nullptr)
         {
-            delete [] data_;
+            return;
         }
 
+        options().capacity_site_ = site.site_;
+        options().record_size_   = record_final_size;
+
+        size_t hint = capacity_hint(site.site_);
+        if (hint != 0)
+        {
+            reserve(hint);
+        }
+    }
+
+    constexpr ~Vector()
+    {
+        if (options_ != nullptr)
+        {
+            if (options_->unregister_ != nullptr)
+            {
+                options_->unregister_(this);
+            }
+
+            report_final_size(true);
+        }
+
+        release_data(data_, size_, capacity_);
+
+        delete options_;
+
         destroy_fields();
     }
 
-    Vector (const Vector &other)
+    // Takes the buffer and leaves other empty. Options are not taken: reclaim
+    // registration belongs to the address of other.
+    constexpr Vector(Vector &&other) noexcept
+      : capacity_(other.capacity_),
+        size_    (other.size_),
+        data_    (other.data_)
+    {
+        other.report_final_size(true);                                              // the contents of other end here
+
+        other.capacity_ = 0;
+        other.size_     = 0;
+        other.data_     = nullptr;
+    }
+
+    constexpr Vector (const Vector &other)
       : capacity_(other.capacity_),
         size_    (other.size_)
     {
         try
         {
-            data_ = new char[capacity_ * sizeof(Type)];
+            data_ = allocate_data(capacity_);
         }
         catch (...)
         {
-            std::cerr << "ERROR: vector data was not allocated" << std::endl;
+            REPORT_EVENT(DiagCode::NOT_ALLOCATED, capacity_);
             destroy_fields();
 
             throw;
         }
 
-        copy_data_to_uninit_place(data_, other.data_, other.size_);
+        try
+        {
+            copy_data_to_uninit_place(data_, other.data_, other.size_);
+        }
+        catch (...)
+        {
+            release_data(data_, 0, capacity_);
+            destroy_fields();
+
+            throw;
+        }
     }
 
-    Vector &operator =(Vector other)
+    constexpr Vector &operator =(const Vector &other)
     {
-        this->swap(other);
+        Vector copy(other);
+        replace_data(copy);
+
+        return *this;
+    }
+
+    constexpr Vector &operator =(Vector &&other) noexcept
+    {
+        if (this != &other)
+        {
+            replace_data(other);
+        }
 
         return *this;
     }
@@ -125,7 +288,7 @@ public:
 //----------------------------------Dump-------------------------------------------
 
     void dump(void (*dump_elem)(const Type &value), size_t from = 0, size_t to = VECTOR_MAX_CAPACITY + 1)
-    {   
+    {
         if (to == VECTOR_MAX_CAPACITY + 1)
         {
             to = capacity_;
@@ -138,176 +301,262 @@ public:
         for (; from < to; ++from)
         {
             std::cout << "vector[" << from << "] = ";
-            dump_elem(reinterpret_cast<const Type &> (data_[from * sizeof(Type)]));
-            std::cout << "\t\t\t&vector[" << from << "] = " << reinterpret_cast<void *> (&data_[from * sizeof(Type)]) << std::endl;
+            dump_elem(data_[from]);
+            std::cout << "\t\t\t&vector[" << from << "] = " << static_cast<void *> (&data_[from]) << std::endl;
         }
 
         std::cout << std::endl;
     }
 //------------------------------Verificator----------------------------------------
-    void verificator()
+    constexpr void verificator()
     {
         assert(size_ <= capacity_);
         assert(capacity_ <= VECTOR_MAX_CAPACITY);
-        assert(data != nullptr);
-        assert(data != INVALID_PTR);
+        assert((data_ != nullptr) || (capacity_ == 0));
+        assert(data_is_valid());
     }
 
 //---------------------------Size and capacity-------------------------------------
 
-    bool empty() const
+    constexpr bool empty() const
     {
         return size_ == 0;
     }
 
-    size_t size() const
+    constexpr size_t size() const
     {
         return size_;
     }
 
-    size_t max_size() const
+    // For big elements the allocator runs out of addressable bytes first.
+    constexpr size_t max_size() const
     {
-        return VECTOR_MAX_CAPACITY;
+        return std::min(VECTOR_MAX_CAPACITY, std::allocator_traits<std::allocator<Type>>::max_size(std::allocator<Type>()));
     }
 
-    size_t capacity() const
+    constexpr size_t capacity() const
     {
         return capacity_;
     }
 
-    void reserve(size_t reserved_size)
+    constexpr void reserve(size_t reserved_size)
     {
         if (reserved_size <= capacity_)
         {
             return;
         }
 
-        char *new_data = const_cast<char *> (UNINIT_PTR);
+        Type *new_data = nullptr;
         try
         {
             new_data = vector_realloc(reserved_size);
         }
         catch (...)
         {
-            std::cerr << "ERROR: reserving memory failed" << std::endl; 
+            REPORT_EVENT(DiagCode::RESERVE_FAILED, reserved_size);
 
             throw;
         }
 
-        if ((data_is_valid()) && (data_ != const_cast<char *> (UNINIT_PTR)))
-        {
-            delete [] data_;
-        }
+        release_data(data_, 0, capacity_);
 
         data_     = new_data;
         capacity_ = reserved_size;
     }
 
-    void shrink_to_fit()
+    constexpr void shrink_to_fit()
     {
         if (capacity_ == size_)
         {
             return;
         }
 
-        char *new_data = const_cast<char *> (UNINIT_PTR);
         try
         {
-            new_data = vector_realloc(size_);
+            relocate(size_);
         }
         catch (...)
         {
-            std::cerr << "ERROR: shrink_to_fit failed" << std::endl;
+            REPORT_EVENT(DiagCode::SHRINK_FAILED, size_, capacity_);
 
             throw;
         }
-        copy_data_to_uninit_place(new_data, data_, size_);
-        destroy_existing_elems(0, size_);
+    }
+
+//---------------------------Memory reclamation------------------------------------
 
-        if ((data_is_valid()) && (data_ != const_cast<char *> (UNINIT_PTR)))
+    constexpr void set_shrink_policy(const ShrinkPolicy &policy)
+    {
+        if ((options_ == nullptr) && (policy.ratio_ == 0))
         {
-            delete [] data_;
+            return;
         }
 
-        data_     = new_data;
-        capacity_ = size_;
+        options().shrink_policy_    = policy;
+        options().low_usage_streak_ = 0;
+        options().peak_size_        = size_;
+    }
+
+    constexpr const ShrinkPolicy &shrink_policy() const
+    {
+        return options_ == nullptr ? NO_SHRINK_POLICY : options_->shrink_policy_;
+    }
+
+    // Lets reclaim() trim this vector under memory pressure. Registration is tied
+    // to the address of the object: copies are not registered, swap keeps it in place.
+    void enable_reclaim()
+    {
+        if (options().unregister_ == nullptr)
+        {
+            register_reclaimable(this, reclaim_slack, reclaim_trim);
+            options().unregister_ = unregister_reclaimable;
+        }
+    }
+
+    void disable_reclaim()
+    {
+        if ((options_ != nullptr) && (options_->unregister_ != nullptr))
+        {
+            options_->unregister_(this);
+            options_->unregister_ = nullptr;
+        }
+    }
+
+    // In deferred mode buffers given up by destruction, reset() and reallocation
+    // are released by the background reclaimer (see deferred_reclaimer.hpp).
+    constexpr void set_deferred_release(bool deferred)
+    {
+        if ((options_ == nullptr) && (!deferred))
+        {
+            return;
+        }
+
+        options().defer_ = deferred ? defer_release : nullptr;
+    }
+
+    constexpr bool deferred_release() const
+    {
+        return (options_ != nullptr) && (options_->defer_ != nullptr);
     }
 
 //-----------------------------Operating elements----------------------------------
 
-    const Type &operator [](const size_t index) const
+    constexpr const Type &operator [](const size_t index) const
     {
         return const_cast<const Type &>(const_cast<Vector<Type> *>(this)->operator[](index));
     }
 
-    Type &operator [](const size_t index)
+    constexpr Type &operator [](const size_t index)
     {
         assert(index < capacity_);
 
-        return reinterpret_cast<Type &> (data_[index * sizeof(Type)]);
+        return data_[index];
     }
 
-    const Type &at(const size_t index) const
+    constexpr const Type &at(const size_t index) const
     {
        return const_cast<const Type &>(const_cast<Vector<Type> *>(this)->at(index));
     }
 
-    Type &at(const size_t index)
+    constexpr Type &at(const size_t index)
     {
         if (index < capacity_)
         {
             return this->operator[](index);
         }
 
-        std::cerr << "ERROR: attempt to get value out of bounds" << std::endl;
+        REPORT_EVENT(DiagCode::GET_OUT_OF_BOUNDS, index, size_);
 
         throw std::out_of_range("ERROR: attempt to get value out of bounds");
     }
 
-    const Type &front() const
+    constexpr const Type &front() const
     {
         return const_cast<const Type &>(const_cast<Vector<Type> *>(this)->front());
     }
 
-    Type &front()
+    constexpr Type &front()
     {
-        return reinterpret_cast<Type &> (data_[0]);
+        return data_[0];
     }
 
-    const Type &back() const
+    constexpr const Type &back() const
     {
         return const_cast<const Type &>(const_cast<Vector<Type> *>(this)->back());
     }
 
-    Type &back()
+    constexpr Type &back()
+    {
+        return data_[size_ - 1];
+    }
+
+    constexpr const Type *data() const
     {
-        return reinterpret_cast<Type &> (data_[(size_ - 1) * sizeof(Type)]);
+        return data_;
     }
 
-    const Type *data() const
+    constexpr Type *data()
     {
-        return const_cast<const Type &>(const_cast<Vector<Type> *>(this)->data());
+        return data_;
     }
 
-    Type *data()
+    constexpr const Type *begin() const
     {
-        return reinterpret_cast<Type *> (data_);
+        return data_;
+    }
+
+    constexpr Type *begin()
+    {
+        return data_;
+    }
+
+    constexpr const Type *end() const
+    {
+        return data_ + size_;
+    }
+
+    constexpr Type *end()
+    {
+        return data_ + size_;
     }
 
 //---------------------------Modifiers---------------------------------------------
 
-    void clear()
+    constexpr void clear()
     {
+        report_final_size();
+
         destroy_existing_elems(0, size_);
 
         size_ = 0;
+
+        maybe_shrink();
     }
 
-    Type &insert(size_t index, const Type &value)
+    // clear() and shrink_to_fit() in one step: in deferred mode even the
+    // elements are destroyed on the reclaimer thread.
+    constexpr void reset()
+    {
+        report_final_size();
+
+        release_data(data_, size_, capacity_);
+
+        data_     = nullptr;
+        size_     = 0;
+        capacity_ = 0;
+
+        if (options_ != nullptr)
+        {
+            options_->low_usage_streak_ = 0;
+            options_->peak_size_        = 0;
+        }
+    }
+
+    constexpr Type &insert(size_t index, const Type &value)
     {
         if ((index > capacity_) || ((index == capacity_) && (size_ != capacity_)))
         {
-            std::cerr << "ERROR: attempt to insert out of bounds" << std::endl;
+            REPORT_EVENT(DiagCode::INSERT_OUT_OF_BOUNDS, index, size_);
 
             throw std::out_of_range("ERROR: attempt to insert out of bounds");
         }
@@ -316,82 +565,115 @@ public:
             index = size_;
         }
 
-        TRY_CATCH_BLOCK_STRICT_EXCEPTION_WARRANTY
-        (
-            reserve(size_ + 1);
-            init_elements(size_, size_ + 1);
-            copy_data(data_ + (index + 1) * sizeof(Type), data_ + index * sizeof(Type), size_ - index);
+        try
+        {
+            if (size_ == capacity_)
+            {
+                insert_reallocating(index, value);
+            }
+            else if (index == size_)
+            {
+                std::construct_at(data_ + size_, value);
+            }
+            else if constexpr (IS_NOTHROW_MOVABLE)
+            {
+                insert_shifting(index, value);
+            }
+            else
+            {
+                TRY_CATCH_BLOCK_STRICT_EXCEPTION_WARRANTY
+                (
+                    insert_shifting(index, value);
+                ,
+                )
+            }
+        }
+        catch (...)
+        {
+            REPORT_EVENT(DiagCode::INSERT_FAILED, index, size_);
 
-            ++size_;
+            throw;
+        }
+
+        ++size_;
 
-            reinterpret_cast<Type &> (data_[index * sizeof(Type)]) = value;
-        ,
-    
-            std::cerr << "ERROR: insertion failed" << std::endl;
-        )
+        note_peak_size();
 
-        return reinterpret_cast<Type &> (data_[index * sizeof(Type)]);
+        return data_[index];
     }
 
-    Type &erase(size_t index)
+    constexpr Type &erase(size_t index)
     {
         if ((index > capacity_) || ((index == capacity_) && (size_ != capacity_)))
         {
-            std::cerr << "ERROR: attempt to erase out of bounds" << std::endl;
+            REPORT_EVENT(DiagCode::ERASE_OUT_OF_BOUNDS, index, size_);
 
             throw std::out_of_range("ERROR: attempt to erase out of bounds");
         }
 
         if (index >= size_)
         {
-            return reinterpret_cast<Type &> (data_[index * sizeof(Type)]);
+            return data_[index];
+        }
+
+        REPORT_TRACE(DiagCode::ERASE_TRACE, index, size_);
+
+        if constexpr (IS_NOTHROW_MOVABLE)
+        {
+            std::move(data_ + index + 1, data_ + size_, data_ + index);
+        }
+        else
+        {
+            TRY_CATCH_BLOCK_STRICT_EXCEPTION_WARRANTY
+            (
+                std::move(data_ + index + 1, data_ + size_, data_ + index);
+            ,
+                REPORT_EVENT(DiagCode::ERASE_FAILED, index, size_);
+            )
         }
 
-        TRY_CATCH_BLOCK_STRICT_EXCEPTION_WARRANTY
-        (
-            copy_data(data_ + index * sizeof(Type), data_ + (index + 1) * sizeof(Type), size_ - index);
-            std::cout << "size_: " << size_ << std::endl;
-            destroy_existing_elems(size_ - 1, size_);
+        destroy_existing_elems(size_ - 1, size_);
 
-            --size_;
-        ,
+        --size_;
 
-            std::cerr << "ERROR: erase failed" << std::endl;  
-        )
+        maybe_shrink();
 
-        return reinterpret_cast<Type &> (data_[(index + 1) * sizeof(Type)]);
+        return data_[index];
     }
 
-    void push_back(const Type &value)
+    constexpr void push_back(const Type &value)
     {
-        TRY_CATCH_BLOCK_STRICT_EXCEPTION_WARRANTY
-        (
+        try
+        {
             insert(size_, value);
-        ,
-            std::cerr << "ERROR: push_back failed" << std::endl;
-        )
+        }
+        catch (...)
+        {
+            REPORT_EVENT(DiagCode::PUSH_BACK_FAILED, size_);
+
+            throw;
+        }
     }
 
-    void pop_back()
+    constexpr void pop_back()
     {
         if (size_ == 0)
         {
             return;
         }
 
-        TRY_CATCH_BLOCK_STRICT_EXCEPTION_WARRANTY
-        (
-            erase(size_ - 1);
-        ,
-            std::cerr << "ERROR: pop_back failed" << std::endl;
-        )
+        destroy_existing_elems(size_ - 1, size_);
+
+        --size_;
+
+        maybe_shrink();
     }
 
-    void resize(size_t new_size, const Type &value = Type())
+    constexpr void resize(size_t new_size, const Type &value = Type())
     {
         if (new_size > VECTOR_MAX_CAPACITY)
         {
-            throw std::bad_alloc("ERROR: resizing requires too much memory");
+            throw std::length_error("ERROR: resizing requires too much memory");
         }
 
         if (new_size <= size_)                                                      // new size is smaller or equal to previous
@@ -400,6 +682,8 @@ public:
 
             size_ = new_size;
 
+            maybe_shrink();
+
             return;
         }
 
@@ -409,156 +693,469 @@ public:
 
             size_ = new_size;
 
+            note_peak_size();
+
             return;
         }
 
-        size_t new_capacity = calculate_enough_capacity(capacity_, new_size);       // new size is bigger than capacity
-        char *new_data = const_cast<char *> (UNINIT_PTR);
-        try
+        try                                                                         // new size is bigger than capacity
         {
-            new_data = vector_realloc(new_capacity);
+            resize_reallocating(new_size, value);
         }
         catch (...)
         {
-            std::cerr << "ERROR: resizing failed" << std::endl; 
+            REPORT_EVENT(DiagCode::RESIZE_FAILED, size_, new_size);
 
             throw;
         }
-        init_elements(size_, new_size, value);
-
-        if ((data_is_valid()) && (data_ != UNINIT_PTR))
-        {
-            delete [] data_;
-        }
 
-        data_     = new_data;
-        capacity_ = new_capacity;
-        size_     = new_size;
+        note_peak_size();
     }
 
-    void swap(Vector &other)
+    constexpr void swap(Vector &other) noexcept
     {
         std::swap(capacity_, other.capacity_);
         std::swap(size_, other.size_);
         std::swap(data_, other.data_);
     }
 
+//---------------------------Sorting-----------------------------------------------
+// Defined in vector_sort.hpp. Integral and floating point keys are radix sorted, other
+// keys are compared with <. workers == 0 starts one worker per hardware thread, and
+// key is called from all of them at once. scratch only lends its buffer (it is left
+// empty with at least size() capacity), so it can be reused between sorts.
+
+    void sort(size_t workers = 0);
+
+    template <class KeyFunc>
+    void sort_by_key(KeyFunc key, size_t workers = 0);
+
+    template <class KeyFunc>
+    void sort_by_key(KeyFunc key, Vector &scratch, size_t workers = 0);
+
 //operators
 private:
 //--------------------------Utility functions--------------------------------------
 
-    size_t calculate_enough_capacity(size_t required_size) 
+    // Constructs [from, to) or nothing: a failure destroys what was already built.
+    constexpr void init_elements(size_t from, size_t to, const Type &value = Type())
     {
-        size_t capacity = 1;
-
-        for (int base = 32; base > 0; base /= 2)
+        size_t index = from;
+        try
         {
-            if (required_size >= (capacity << base))
+            for (; index < to; ++index)
             {
-                capacity <<= base;
+                std::construct_at(data_ + index, value);
             }
         }
+        catch (...)
+        {
+            REPORT_EVENT(DiagCode::INIT_FAILED, from, to);
 
-        capacity <<= 1;
-
-        return capacity > VECTOR_MAX_CAPACITY ? VECTOR_MAX_CAPACITY : capacity;
-    }
+            destroy_existing_elems(from, index);
 
-    void init_elements(size_t from, size_t to, const Type &value = Type())
-    {                                                   
-        TRY_CATCH_BLOCK_STRICT_EXCEPTION_WARRANTY
-        (
-            for (size_t vector_elem_index = from; vector_elem_index < to; ++vector_elem_index)
-            {
-                new (data_ + vector_elem_index * sizeof(Type)) Type(value);
-            }    
-        ,                                                         
-            std::cerr << "ERROR: sequental initialization failed" << std::endl;
-        )                                                                          
+            throw;
+        }
     }
 
-    void copy_data_to_uninit_place(char *dest, const char *src, size_t quantity)
+    constexpr void copy_data_to_uninit_place(Type *dest, const Type *src, size_t quantity)
     {
         if ((dest == nullptr) || (src == nullptr))
         {
             return;
         }
 
-        for (size_t index = 0; index < quantity; ++index)
+        size_t index = 0;
+        try
         {
-            const Type &elem_to_copy = reinterpret_cast<const Type &> (src[index * sizeof(Type)]);
-            new (dest + index * sizeof(Type)) Type(elem_to_copy);
+            for (; index < quantity; ++index)
+            {
+                std::construct_at(dest + index, src[index]);
+            }
+        }
+        catch (...)
+        {
+            for (size_t constructed = 0; constructed < index; ++constructed)
+            {
+                std::destroy_at(dest + constructed);
+            }
+
+            throw;
         }
     }
 
-    void copy_data(char *dest, const char *src, size_t quantity)
+    // Moves elements unless that may throw, so a failure leaves src untouched.
+    constexpr void move_data_to_uninit_place(Type *dest, Type *src, size_t quantity)
     {
-        if ((dest == nullptr) || (src == nullptr))
+        size_t index = 0;
+        try
         {
-            return;
+            for (; index < quantity; ++index)
+            {
+                std::construct_at(dest + index, std::move_if_noexcept(src[index]));
+            }
         }
+        catch (...)
+        {
+            for (size_t constructed = 0; constructed < index; ++constructed)
+            {
+                std::destroy_at(dest + constructed);
+            }
 
-        Type *casted_dest      = reinterpret_cast<Type *> (dest);
-        const Type *casted_src = reinterpret_cast<const Type *> (src); 
+            throw;
+        }
+    }
 
-        if (dest == src)
+    // Full buffer: the new element is built straight in a bigger one and the others are
+    // moved around it, so each of them is touched once. The old buffer is only released
+    // when everything succeeded.
+    constexpr void insert_reallocating(size_t index, const Type &value)
+    {
+        size_t new_capacity = calculate_enough_capacity(size_ + 1);
+        if (new_capacity > VECTOR_MAX_CAPACITY)
         {
-            return;
+            throw std::length_error("ERROR: insertion requires too much memory");
+        }
+
+        Type *new_data = allocate_data(new_capacity);
+        size_t built   = 0;                                                         // elements of new_data before index already constructed
+        bool inserted  = false;
+        try
+        {
+            std::construct_at(new_data + index, value);                             // value may live in the old buffer
+            inserted = true;
+
+            move_data_to_uninit_place(new_data, data_, index);
+            built = index;
+
+            move_data_to_uninit_place(new_data + index + 1, data_ + index, size_ - index);
         }
-        
-        if (dest < src)
+        catch (...)
         {
-            for (size_t counter = 0; counter < quantity; ++counter)
+            for (size_t constructed = 0; constructed < built; ++constructed)
             {
-                *(casted_dest + counter) = *(casted_src + counter);
+                std::destroy_at(new_data + constructed);
             }
+            if (inserted)
+            {
+                std::destroy_at(new_data + index);
+            }
+            release_data(new_data, 0, new_capacity);
+
+            throw;
         }
-        else
+
+        release_data(data_, size_, capacity_);
+
+        data_     = new_data;
+        capacity_ = new_capacity;
+    }
+
+    // Takes the buffer of other and releases the old one the way this vector releases
+    // buffers, on the reclaimer thread in deferred mode. Leaves other empty.
+    constexpr void replace_data(Vector &other) noexcept
+    {
+        report_final_size();
+        other.report_final_size(true);
+
+        release_data(data_, size_, capacity_);
+
+        data_     = other.data_;
+        size_     = other.size_;
+        capacity_ = other.capacity_;
+
+        other.data_     = nullptr;
+        other.size_     = 0;
+        other.capacity_ = 0;
+
+        note_peak_size();
+    }
+
+    // Growing past capacity: value may be an element of the old buffer, so the new
+    // elements are built from it before the old ones are moved out and released.
+    constexpr void resize_reallocating(size_t new_size, const Type &value)
+    {
+        size_t new_capacity = calculate_enough_capacity(new_size);
+
+        Type *new_data = allocate_data(new_capacity);
+        size_t built   = size_;                                                     // end of the new elements already constructed
+        try
         {
-            for (size_t counter = quantity; counter > 0; --counter)
+            for (; built < new_size; ++built)
             {
-                *(casted_dest + counter - 1) = *(casted_src + counter - 1);
+                std::construct_at(new_data + built, value);
             }
+
+            move_data_to_uninit_place(new_data, data_, size_);
+        }
+        catch (...)
+        {
+            for (size_t index = size_; index < built; ++index)
+            {
+                std::destroy_at(new_data + index);
+            }
+            release_data(new_data, 0, new_capacity);
+
+            throw;
+        }
+
+        release_data(data_, size_, capacity_);
+
+        data_     = new_data;
+        capacity_ = new_capacity;
+        size_     = new_size;
+    }
+
+    // Room is left at the end: elements after index move one step right. The element
+    // built past size_ is destroyed if a later move throws, since the snapshot the
+    // caller swaps back only knows about size_ elements.
+    constexpr void insert_shifting(size_t index, const Type &value)
+    {
+        Type copy = value;                                                          // value may be one of the moved elements
+
+        std::construct_at(data_ + size_, std::move(data_[size_ - 1]));
+        try
+        {
+            std::move_backward(data_ + index, data_ + size_ - 1, data_ + size_);
+
+            data_[index] = std::move(copy);
+        }
+        catch (...)
+        {
+            std::destroy_at(data_ + size_);
+
+            throw;
         }
     }
 
-    char *vector_realloc(size_t new_capacity)
+    constexpr Type *vector_realloc(size_t new_capacity)
     {
-        char *new_data = const_cast<char *> (UNINIT_PTR);
+        Type *new_data = nullptr;
+        try
+        {
+            new_data = allocate_data(new_capacity);
+        }
+        catch (...)
+        {
+            REPORT_EVENT(DiagCode::ALLOCATION_FAILED, new_capacity);
+
+            throw;
+        }
         try
         {
-            new_data = new char[new_capacity * sizeof(Type)];
+            move_data_to_uninit_place(new_data, data_, size_);
         }
         catch (...)
         {
-            std::cout << "ERROR: allocating more memory failed" << std::endl;
+            release_data(new_data, 0, new_capacity);
 
             throw;
         }
-        copy_data_to_uninit_place(new_data, data_, size_);
         destroy_existing_elems(0, size_);
 
         return new_data;
     }
 
-    bool data_is_valid()
+    constexpr void relocate(size_t new_capacity)
+    {
+        Type *new_data = vector_realloc(new_capacity);
+
+        release_data(data_, 0, capacity_);
+
+        data_     = new_data;
+        capacity_ = new_capacity;
+    }
+
+    // A vector that is cleared and refilled reports every round it went through. Rounds
+    // ended by clear() or reset() count when they had elements; the last one (destruction,
+    // being moved from) counts even when empty unless something was recorded before, so
+    // sites where vectors mostly stay empty learn that too.
+    constexpr void report_final_size(bool last = false)
+    {
+        if ((options_ == nullptr) || (options_->capacity_site_ == nullptr))
+        {
+            return;
+        }
+
+        if ((size_ != 0) || ((last) && (!options_->size_recorded_)))
+        {
+            options_->record_size_(options_->capacity_site_, size_);
+            options_->size_recorded_ = true;
+        }
+    }
+
+    // Growing operations call this, so maybe_shrink() sees the peak of the round
+    // even when it ended with the vector emptied.
+    constexpr void note_peak_size()
+    {
+        if ((options_ != nullptr) && (size_ > options_->peak_size_))
+        {
+            options_->peak_size_ = size_;
+        }
+    }
+
+    constexpr void maybe_shrink()
+    {
+        if (options_ == nullptr)
+        {
+            return;
+        }
+
+        size_t peak_size = std::max(options_->peak_size_, size_);
+        options_->peak_size_ = size_;
+
+        const ShrinkPolicy &policy = options_->shrink_policy_;
+        if ((policy.ratio_ == 0) || (peak_size * policy.ratio_ >= capacity_))
+        {
+            options_->low_usage_streak_ = 0;
+
+            return;
+        }
+
+        if (++options_->low_usage_streak_ < policy.patience_)
+        {
+            return;
+        }
+        options_->low_usage_streak_ = 0;
+
+        size_t new_capacity = size_ == 0 ? 0 : calculate_enough_capacity(size_);
+        if (new_capacity >= capacity_)
+        {
+            return;
+        }
+
+        try
+        {
+            relocate(new_capacity);
+        }
+        catch (...)                                                                 // keeping the old buffer is fine
+        {
+        }
+    }
+
+    static size_t reclaim_slack(const void *object)
+    {
+        const Vector *vector = static_cast<const Vector *> (object);
+
+        return (vector->capacity_ - vector->size_) * sizeof(Type);
+    }
+
+    static size_t reclaim_trim(void *object)
+    {
+        Vector *vector  = static_cast<Vector *> (object);
+        size_t released = reclaim_slack(object);
+
+        try
+        {
+            vector->shrink_to_fit();
+        }
+        catch (...)
+        {
+            return 0;
+        }
+
+        return released;
+    }
+
+    static constexpr Type *allocate_data(size_t capacity)
+    {
+        if (capacity == 0)
+        {
+            return nullptr;
+        }
+
+        return std::allocator<Type>().allocate(capacity);
+    }
+
+    // Destroys the first size elements of data and frees it, on the reclaimer thread in deferred mode.
+    constexpr void release_data(Type *data, size_t size, size_t capacity)
+    {
+        if ((data == nullptr) || (!data_is_valid()))
+        {
+            return;
+        }
+
+        if (!std::is_constant_evaluated())
+        {
+            release_data_at_runtime(data, size, capacity, options_ == nullptr ? nullptr : options_->defer_);
+
+            return;
+        }
+
+        release_buffer(data, size, capacity);
+    }
+
+    static void release_data_at_runtime(Type *data, size_t size, size_t capacity, bool (*defer)(const ReclaimJob &job))
+    {
+        IF_MEASURE_RELEASE_LATENCY(ReleaseTimer release_timer;)
+
+        if (std::is_trivially_destructible<Type>::value)
+        {
+            size = 0;
+        }
+
+        if ((defer != nullptr) && (defer(ReclaimJob{data, size, capacity, release_buffer_job})))
+        {
+            return;
+        }
+
+        release_buffer(data, size, capacity);
+    }
+
+    static constexpr void release_buffer(Type *data, size_t size, size_t capacity)
+    {
+        for (size_t index = 0; index < size; ++index)
+        {
+            std::destroy_at(data + index);
+        }
+
+        std::allocator<Type>().deallocate(data, capacity);
+    }
+
+    static void release_buffer_job(void *data, size_t size, size_t capacity)
     {
-        return (data_ != DESTR_PTR) && (data_ != INVALID_PTR);
+        release_buffer(static_cast<Type *> (data), size, capacity);
     }
 
-    void destroy_existing_elems(size_t from, size_t to)
+    constexpr bool data_is_valid() const
+    {
+        if (std::is_constant_evaluated())
+        {
+            return true;
+        }
+
+        return (static_cast<const void *> (data_) != DESTR_PTR) && (static_cast<const void *> (data_) != INVALID_PTR);
+    }
+
+    constexpr void destroy_existing_elems(size_t from, size_t to)
     {
         for (size_t index = from; index < to; ++index)
         {
-            (reinterpret_cast<Type *> (data_))[index * sizeof(Type)].~Type();
+            std::destroy_at(data_ + index);
         }
     }
 
-    void destroy_fields()
+    constexpr VectorOptions &options()
+    {
+        if (options_ == nullptr)
+        {
+            options_ = new VectorOptions();
+        }
+
+        return *options_;
+    }
+
+    constexpr void destroy_fields()
     {
         capacity_ = POISONED_SIZE_T;
         size_     = POISONED_SIZE_T;
-        data_     = const_cast<char *> (DESTR_PTR);
+        data_     = nullptr;
+        options_  = nullptr;
+
+        if (!std::is_constant_evaluated())
+        {
+            data_ = reinterpret_cast<Type *> (const_cast<char *> (DESTR_PTR));
+        }
     }
 
 private:
@@ -566,23 +1163,17 @@ private:
 
     size_t capacity_  = 0;
     size_t size_      = 0;
-    
-    char *data_ = const_cast<char *> (UNINIT_PTR);
+
+    Type *data_ = nullptr;
+
+    VectorOptions *options_ = nullptr;                                              // see VectorOptions
 };
 
 
+// Capacity is not part of the value: equal elements make equal vectors (and equal hashes).
 template<class Type>
-int vector_cmp(const Vector<Type> &v1, const Vector<Type> &v2)
+constexpr int vector_cmp(const Vector<Type> &v1, const Vector<Type> &v2)
 {
-    if (v1.capacity() > v2.capacity())
-    {
-        return 1;
-    }
-    if (v1.capacity() < v2.capacity())
-    {
-        return -1;
-    }
-
     if (v1.size() > v2.size())
     {
         return 1;
@@ -592,65 +1183,61 @@ int vector_cmp(const Vector<Type> &v1, const Vector<Type> &v2)
         return -1;
     }
 
-    for (long long cur_elem_index = 0; cur_elem_index < v1.size(); ++cur_elem_index)
+    for (size_t cur_elem_index = 0; cur_elem_index < v1.size(); ++cur_elem_index)
     {
-        const char *v1_data_ptr = v1.data() + cur_elem_index * sizeof(Type) - 1;
-        const char *v2_data_ptr = v2.data() + cur_elem_index * sizeof(Type) - 1;
-
-        for (int cur_byte = sizeof(Type); cur_byte > 0; --cur_byte)
+        if (v2[cur_elem_index] < v1[cur_elem_index])
         {
-            if (*v1_data_ptr > *v2_data_ptr)
-            {
-                return 1;
-            }
-
-            if (*v1_data_ptr < *v2_data_ptr)
-            {
-                return -1;
-            }
+            return 1;
+        }
 
-            --v1_data_ptr;
-            --v2_data_ptr;
-        }        
+        if (v1[cur_elem_index] < v2[cur_elem_index])
+        {
+            return -1;
+        }
     }
 
     return 0;
 }
 
 template<class Type>
-bool operator ==(const Vector<Type> &v1, const Vector<Type> &v2)
+constexpr bool operator ==(const Vector<Type> &v1, const Vector<Type> &v2)
 {
     return vector_cmp(v1, v2) == 0;
 }
 
 template<class Type>
-bool operator !=(const Vector<Type> &v1, const Vector<Type> &v2)
+constexpr bool operator !=(const Vector<Type> &v1, const Vector<Type> &v2)
 {
     return vector_cmp(v1, v2) != 0;
 }
 
 template<class Type>
-bool operator <(const Vector<Type> &v1, const Vector<Type> &v2)
+constexpr bool operator <(const Vector<Type> &v1, const Vector<Type> &v2)
 {
     return vector_cmp(v1, v2) == -1;
 }
 
 template<class Type>
-bool operator <=(const Vector<Type> &v1, const Vector<Type> &v2)
+constexpr bool operator <=(const Vector<Type> &v1, const Vector<Type> &v2)
 {
     return vector_cmp(v1, v2) <= 0;
 }
 
 template<class Type>
-bool operator >(const Vector<Type> &v1, const Vector<Type> &v2)
+constexpr bool operator >(const Vector<Type> &v1, const Vector<Type> &v2)
 {
     return vector_cmp(v1, v2) == 1;
 }
 
 template<class Type>
-bool operator >=(const Vector<Type> &v1, const Vector<Type> &v2)
+constexpr bool operator >=(const Vector<Type> &v1, const Vector<Type> &v2)
 {
     return vector_cmp(v1, v2) >= 0;
 }
 
+
+#include "bit_vector.hpp"
+#include "vector_sort.hpp"
+
+
 #endif
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "vector.hpp"
+
+
+//---------------------------Checks------------------------------------------------
+// Random inputs of every key kind are sorted with several worker counts and compared
+// with std::sort. Elements carry their original index, so a lost or duplicated
+// element is caught, not only a wrong order. Record has no default constructor,
+// since the sort must not need one; with a shared_ptr index it is not trivially
+// copyable either, which takes the path that prepares scratch slots.
+
+const size_t CHECK_SIZES[]   = {0, 1, 2, 1000, 1023, 1024, 1025, 5000, 70001, 300000};
+const size_t CHECK_WORKERS[] = {1, 2, 3, 8};
+
+using SharedId = std::shared_ptr<const size_t>;
+
+template <class Key, class Id = size_t>
+class Record
+{
+public:
+
+    Record(Key key, size_t id)
+      : key_(key)
+    {
+        if constexpr (std::is_same_v<Id, SharedId>)
+        {
+            id_ = std::make_shared<const size_t> (id);
+        }
+        else
+        {
+            id_ = id;
+        }
+    }
+
+    const Key &key() const
+    {
+        return key_;
+    }
+
+    size_t id() const
+    {
+        if constexpr (std::is_same_v<Id, SharedId>)
+        {
+            return *id_;
+        }
+        else
+        {
+            return id_;
+        }
+    }
+
+private:
+
+    Key key_;
+    Id  id_ = Id();
+};
+
+template <class Key, class Id = size_t, class MakeKey>
+static bool check_sort(const char *name, MakeKey make_key, std::mt19937_64 &generator)
+{
+    using Element = Record<Key, Id>;
+
+    auto key = [](const Element &record) -> const Key &
+    {
+        return record.key();
+    };
+
+    for (size_t size : CHECK_SIZES)
+    {
+        for (size_t workers : CHECK_WORKERS)
+        {
+            Vector<Element> records;
+            std::vector<Key> expected;
+            for (size_t id = 0; id < size; ++id)
+            {
+                Key value = make_key(generator);
+
+                records.push_back(Element(value, id));
+                expected.push_back(value);
+            }
+
+            std::vector<Key> original = expected;
+            std::sort(expected.begin(), expected.end());
+
+            Vector<Element> scratch;
+            records.sort_by_key(key, scratch, workers);
+
+            std::vector<bool> seen(size, false);
+            bool passed = records.size() == size;
+            for (size_t index = 0; passed && (index < size); ++index)
+            {
+                const Element &record = records[index];
+
+                passed = (record.id() < size) && !seen[record.id()] &&
+                         !(record.key() < expected[index]) && !(expected[index] < record.key()) &&
+                         !(record.key() < original[record.id()]) && !(original[record.id()] < record.key());
+
+                seen[record.id()] = true;
+            }
+
+            if (!passed)
+            {
+                std::cerr << "ERROR: sorting " << size << " " << name << " keys with " << workers
+                          << " workers differs from std::sort" << std::endl;
+
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool check_sorting()
+{
+    std::mt19937_64 generator(1);
+
+    auto int32_key = [](std::mt19937_64 &generator)
+    {
+        return static_cast<int32_t> (generator());
+    };
+
+    auto uint64_key = [](std::mt19937_64 &generator)
+    {
+        return generator();
+    };
+
+    auto few_distinct_key = [](std::mt19937_64 &generator)
+    {
+        return static_cast<int8_t> (generator() % 5) - 2;
+    };
+
+    auto double_key = [](std::mt19937_64 &generator)
+    {
+        return std::uniform_real_distribution<double>(-1e6, 1e6)(generator);
+    };
+
+    auto string_key = [](std::mt19937_64 &generator)
+    {
+        return std::to_string(generator() % 100000);
+    };
+
+    bool passed = check_sort<int32_t>("int32_t", int32_key, generator);
+    passed = check_sort<uint64_t>("uint64_t", uint64_key, generator) && passed;
+    passed = check_sort<int>("few distinct", few_distinct_key, generator) && passed;
+    passed = check_sort<double>("double", double_key, generator) && passed;
+    passed = check_sort<std::string>("std::string", string_key, generator) && passed;
+    passed = check_sort<uint64_t, SharedId>("uint64_t (not trivially copyable)", uint64_key, generator) && passed;
+    passed = check_sort<int32_t, SharedId>("int32_t (not trivially copyable)", int32_key, generator) && passed;
+
+    return passed;
+}
+
+
+//---------------------------Worker sweep------------------------------------------
+// Sorts the same random keys with 1, 2, 4, ... workers up to the hardware threads
+// and prints millions of elements per second next to std::sort.
+
+const size_t BENCH_SIZE    = static_cast<size_t> (1) << 24;
+const size_t BENCH_REPEATS = 3;
+
+template <class Sort>
+static double measure_sort(const Vector<uint64_t> &input, Sort sort)
+{
+    double best = 0;
+    for (size_t repeat = 0; repeat < BENCH_REPEATS; ++repeat)
+    {
+        Vector<uint64_t> keys = input;
+
+        auto start = std::chrono::steady_clock::now();
+        sort(keys);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!std::is_sorted(keys.begin(), keys.end()))
+        {
+            return 0;
+        }
+
+        best = std::max(best, static_cast<double> (keys.size()) / elapsed.count() / 1e6);
+    }
+
+    return best;
+}
+
+static bool bench_workers()
+{
+    std::mt19937_64 generator(2);
+
+    Vector<uint64_t> input(BENCH_SIZE);
+    for (uint64_t &value : input)
+    {
+        value = generator();
+    }
+
+    size_t hardware_threads = std::max<size_t> (std::thread::hardware_concurrency(), 1);
+
+    double std_rate = measure_sort(input, [](Vector<uint64_t> &keys){ std::sort(keys.begin(), keys.end()); });
+
+    std::cout << std::fixed << std::setprecision(1) << BENCH_SIZE << " uint64_t keys, " << hardware_threads
+              << " hardware threads: std::sort " << std_rate << " Melements/s" << std::endl;
+
+    bool passed = std_rate != 0;
+
+    Vector<uint64_t> scratch;
+    for (size_t workers = 1; ; workers = std::min(2 * workers, hardware_threads))
+    {
+        double rate = measure_sort(input, [&scratch, workers](Vector<uint64_t> &keys)
+        {
+            keys.sort_by_key(std::identity(), scratch, workers);
+        });
+
+        std::cout << "  " << workers << " workers: " << rate << " Melements/s" << std::endl;
+
+        passed = (rate != 0) && passed;
+
+        if (workers == hardware_threads)
+        {
+            break;
+        }
+    }
+
+    if (!passed)
+    {
+        std::cerr << "ERROR: the benchmark left unsorted keys" << std::endl;
+    }
+
+    return passed;
+}
+
+
+int main()
+{
+    bool passed = check_sorting();
+    passed = bench_workers() && passed;
+
+    return passed ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,511 @@
+#ifndef VECTOR_SORT_HPP
+#define VECTOR_SORT_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "vector.hpp"
+
+
+//---------------------------Const section-----------------------------------------
+const size_t RADIX_BITS    = 8;
+const size_t RADIX_BUCKETS = static_cast<size_t> (1) << RADIX_BITS;
+
+const size_t SORT_SEQUENTIAL_THRESHOLD = 1024;                                      // below it std::sort on the calling thread is faster
+const size_t SORT_MIN_CHUNK            = static_cast<size_t> (1) << 16;             // elements per worker, fewer workers are started for small inputs
+
+
+//---------------------------Radix keys--------------------------------------------
+// Integral and floating point keys are turned into unsigned integers with the same
+// order, so the radix passes only deal with unsigned digits.
+
+template <class Key>
+constexpr bool IS_RADIX_KEY = (std::is_integral_v<Key> && !std::is_same_v<Key, bool>) ||
+                              std::is_same_v<Key, float> || std::is_same_v<Key, double>;
+
+template <class Key>
+using RadixBits = std::conditional_t<std::is_floating_point_v<Key>,
+                                     std::conditional_t<sizeof(Key) == sizeof(uint32_t), uint32_t, uint64_t>,
+                                     std::make_unsigned_t<std::conditional_t<std::is_floating_point_v<Key>, int, Key>>>;
+
+template <class Key>
+constexpr RadixBits<Key> radix_bits(Key key)
+{
+    using Bits = RadixBits<Key>;
+
+    const Bits sign_bit = static_cast<Bits> (static_cast<Bits> (1) << (sizeof(Bits) * 8 - 1));
+
+    if constexpr (std::is_floating_point_v<Key>)
+    {
+        // Negative numbers are ordered backwards, so all their bits are flipped.
+        Bits bits = std::bit_cast<Bits> (key);
+
+        return (bits & sign_bit) != 0 ? static_cast<Bits> (~bits) : static_cast<Bits> (bits | sign_bit);
+    }
+    else if constexpr (std::is_signed_v<Key>)
+    {
+        return static_cast<Bits> (static_cast<Bits> (key) ^ sign_bit);
+    }
+    else
+    {
+        return static_cast<Bits> (key);
+    }
+}
+
+
+//---------------------------Workers-----------------------------------------------
+
+// 0 means one worker per hardware thread.
+inline size_t sort_worker_count(size_t requested, size_t size)
+{
+    if (requested == 0)
+    {
+        requested = std::max<size_t> (std::thread::hardware_concurrency(), 1);
+    }
+
+    return std::clamp<size_t> (size / SORT_MIN_CHUNK, 1, requested);
+}
+
+// Runs job(worker) for every worker in [0, workers), the last one on the calling
+// thread. The first exception thrown by a worker is rethrown after all of them finished.
+template <class Job>
+void run_workers(size_t workers, Job job)
+{
+    std::exception_ptr failure = nullptr;
+    std::mutex failure_mutex;
+
+    auto guarded_job = [&job, &failure, &failure_mutex](size_t worker)
+    {
+        try
+        {
+            job(worker);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(failure_mutex);
+            if (failure == nullptr)
+            {
+                failure = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+
+    for (size_t worker = 0; worker + 1 < workers; ++worker)
+    {
+        threads.emplace_back(guarded_job, worker);
+    }
+
+    guarded_job(workers - 1);
+
+    for (size_t worker = 0; worker < threads.size(); ++worker)
+    {
+        threads[worker].join();
+    }
+
+    if (failure != nullptr)
+    {
+        std::rethrow_exception(failure);
+    }
+}
+
+constexpr size_t chunk_begin(size_t size, size_t chunks, size_t chunk)
+{
+    return size / chunks * chunk + std::min(chunk, size % chunks);
+}
+
+
+//---------------------------Radix sort--------------------------------------------
+// LSD radix sort, one byte of the key per pass. Every worker counts digits of its own
+// chunk, then the counts are turned into per-worker output positions and every worker
+// scatters its chunk, which keeps the sort stable. Passes where all keys share the
+// digit are skipped. Workers are started once and meet on a barrier between phases.
+template <class Type, class KeyFunc>
+void parallel_radix_sort(Type *data, size_t size, KeyFunc key, Type *scratch, size_t workers)
+{
+    using Bits = RadixBits<std::decay_t<std::invoke_result_t<KeyFunc &, const Type &>>>;
+
+    const size_t PASSES = sizeof(Bits) * 8 / RADIX_BITS;
+
+    Vector<size_t> offsets(workers * RADIX_BUCKETS, 0);
+
+    Type *src     = data;
+    Type *dest    = scratch;
+    bool counting = true;
+    bool skipping = false;
+
+    std::atomic<bool> failed = false;
+
+    std::exception_ptr failure = nullptr;
+    std::mutex failure_mutex;
+
+    // Runs on one thread between phases, while all the others wait on the barrier.
+    auto between_phases = [&]() noexcept
+    {
+        if (!counting)
+        {
+            if (!skipping)
+            {
+                std::swap(src, dest);
+            }
+
+            counting = true;
+
+            return;
+        }
+
+        counting = false;
+        skipping = failed;
+
+        size_t position = 0;
+        for (size_t bucket = 0; (bucket < RADIX_BUCKETS) && !skipping; ++bucket)
+        {
+            size_t bucket_size = 0;
+            for (size_t worker = 0; worker < workers; ++worker)
+            {
+                size_t &offset = offsets[worker * RADIX_BUCKETS + bucket];
+                size_t count   = offset;
+
+                offset       = position;
+                position    += count;
+                bucket_size += count;
+            }
+
+            skipping = bucket_size == size;
+        }
+    };
+
+    std::barrier phase_barrier(static_cast<ptrdiff_t> (workers), between_phases);
+
+    auto record_failure = [&failure, &failure_mutex, &failed]()
+    {
+        std::lock_guard<std::mutex> lock(failure_mutex);
+        if (failure == nullptr)
+        {
+            failure = std::current_exception();
+        }
+
+        failed.store(true);
+    };
+
+    // Moves a chunk to its output ranges, own[bucket] is where the next element of bucket goes.
+    // If that fails, the elements not moved yet fill the rest of the output ranges in any
+    // order, so dest still holds every element and the pass can be swapped in like the others.
+    auto scatter_chunk = [&key, &record_failure](Type *src, Type *dest, size_t from, size_t to, size_t shift,
+                                                 size_t *own, const size_t *counts)
+    {
+        size_t ends[RADIX_BUCKETS] = {};
+        for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        {
+            ends[bucket] = own[bucket] + counts[bucket];
+        }
+
+        size_t index = from;
+        try
+        {
+            for (; index < to; ++index)
+            {
+                size_t bucket = (radix_bits(key(src[index])) >> shift) & (RADIX_BUCKETS - 1);
+
+                dest[own[bucket]] = std::move(src[index]);
+                ++own[bucket];
+            }
+        }
+        catch (...)
+        {
+            record_failure();
+
+            try
+            {
+                for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+                {
+                    for (; (own[bucket] < ends[bucket]) && (index < to); ++own[bucket], ++index)
+                    {
+                        dest[own[bucket]] = std::move(src[index]);
+                    }
+                }
+            }
+            catch (...)                                                             // the rest of the chunk is lost
+            {
+            }
+        }
+    };
+
+    // Workers keep arriving at the barrier after a failure, otherwise the others would hang.
+    // After a failure no more passes are made, but the elements are still brought back to data.
+    auto worker_job = [&](size_t worker)
+    {
+        size_t from  = chunk_begin(size, workers, worker);
+        size_t to    = chunk_begin(size, workers, worker + 1);
+        size_t *own  = &offsets[worker * RADIX_BUCKETS];
+
+        size_t counts[RADIX_BUCKETS] = {};
+
+        for (size_t cur_pass = 0; cur_pass < PASSES; ++cur_pass)
+        {
+            size_t shift = cur_pass * RADIX_BITS;
+
+            try
+            {
+                std::fill(own, own + RADIX_BUCKETS, 0);
+                for (size_t index = from; index < to; ++index)
+                {
+                    ++own[(radix_bits(key(src[index])) >> shift) & (RADIX_BUCKETS - 1)];
+                }
+
+                std::copy(own, own + RADIX_BUCKETS, counts);
+            }
+            catch (...)
+            {
+                record_failure();
+            }
+
+            phase_barrier.arrive_and_wait();
+
+            if (!skipping)
+            {
+                scatter_chunk(src, dest, from, to, shift, own, counts);
+            }
+
+            phase_barrier.arrive_and_wait();
+        }
+
+        if (src != data)
+        {
+            std::move(src + from, src + to, data + from);
+        }
+    };
+
+    run_workers(workers, worker_job);
+
+    if (failure != nullptr)
+    {
+        std::rethrow_exception(failure);
+    }
+}
+
+
+//---------------------------Merge sort--------------------------------------------
+
+// Number of elements taken from first when the first `taken` elements of the stable
+// merge of [first, first + first_size) and [second, second + second_size) are formed.
+template <class Type, class Compare>
+size_t merge_split(const Type *first, size_t first_size, const Type *second, size_t second_size, size_t taken, Compare &less)
+{
+    size_t low  = taken > second_size ? taken - second_size : 0;
+    size_t high = std::min(taken, first_size);
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (!less(second[taken - middle - 1], first[middle]))
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+// Every worker sorts one chunk with std::sort (introsort), then sorted runs are merged
+// pairwise until one is left. A merge round is split by output position, so all
+// workers stay busy even in the last rounds where only a couple of runs are left.
+template <class Type, class Compare>
+void parallel_merge_sort(Type *data, size_t size, Compare less, Type *scratch, size_t workers)
+{
+    run_workers(workers, [data, size, workers, &less](size_t worker)
+    {
+        std::sort(data + chunk_begin(size, workers, worker), data + chunk_begin(size, workers, worker + 1), less);
+    });
+
+    // Run r is [bounds[r], bounds[r + 1]).
+    Vector<size_t> bounds(workers + 1, 0);
+    for (size_t run = 0; run <= workers; ++run)
+    {
+        bounds[run] = chunk_begin(size, workers, run);
+    }
+
+    // splits[worker] is how many elements of the first run of a pair come before the
+    // output position where this worker starts. They are all found before any element
+    // is moved out, as the searches of one worker read the runs another one merges.
+    Vector<size_t> splits(workers + 1, 0);
+
+    Type *src            = data;
+    Type *dest           = scratch;
+    const size_t *runs   = bounds.data();
+    size_t *worker_taken = splits.data();
+
+    for (size_t run_count = workers; run_count > 1; run_count = (run_count + 1) / 2)
+    {
+        run_workers(workers, [=, &less](size_t worker)
+        {
+            size_t out_from = chunk_begin(size, workers, worker);
+
+            for (size_t pair = 0; pair < run_count; pair += 2)
+            {
+                size_t first_begin  = runs[pair];
+                size_t second_begin = runs[std::min(pair + 1, run_count)];
+                size_t second_end   = runs[std::min(pair + 2, run_count)];
+
+                if ((first_begin <= out_from) && (out_from < second_end))
+                {
+                    worker_taken[worker] = merge_split(src + first_begin, second_begin - first_begin,
+                                                       src + second_begin, second_end - second_begin,
+                                                       out_from - first_begin, less);
+                }
+            }
+        });
+
+        run_workers(workers, [=, &less](size_t worker)
+        {
+            size_t out_from = chunk_begin(size, workers, worker);
+            size_t out_to   = chunk_begin(size, workers, worker + 1);
+
+            // Runs of this round are pairs of runs of the previous one.
+            for (size_t pair = 0; pair < run_count; pair += 2)
+            {
+                size_t first_begin  = runs[pair];
+                size_t second_begin = runs[std::min(pair + 1, run_count)];
+                size_t second_end   = runs[std::min(pair + 2, run_count)];
+
+                size_t from = std::max(out_from, first_begin);
+                size_t to   = std::min(out_to, second_end);
+                if (from >= to)
+                {
+                    continue;
+                }
+
+                size_t first_from = from == out_from                        ? worker_taken[worker]     : 0;
+                size_t first_to   = (to == out_to) && (out_to < second_end) ? worker_taken[worker + 1] : second_begin - first_begin;
+
+                std::merge(std::make_move_iterator(src + first_begin  + first_from),
+                           std::make_move_iterator(src + first_begin  + first_to),
+                           std::make_move_iterator(src + second_begin + (from - first_begin - first_from)),
+                           std::make_move_iterator(src + second_begin + (to   - first_begin - first_to)),
+                           dest + from, less);
+            }
+        });
+
+        for (size_t run = 0; run < run_count; run += 2)
+        {
+            bounds[run / 2] = bounds[run];
+        }
+        bounds[(run_count + 1) / 2] = size;
+
+        std::swap(src, dest);
+    }
+
+    if (src != data)
+    {
+        run_workers(workers, [=](size_t worker)
+        {
+            std::move(src + chunk_begin(size, workers, worker), src + chunk_begin(size, workers, worker + 1),
+                      data + chunk_begin(size, workers, worker));
+        });
+    }
+}
+
+
+//---------------------------Vector sorting----------------------------------------
+// The order of equal keys is not specified. If a key function, a comparison or a move
+// throws, the exception is rethrown and the Vector keeps its size with valid elements in
+// no particular order. Radix sorting keeps every value unless a move throws; sorting by
+// comparison loses the values std::sort or a merge had taken out when the exception hit,
+// and moved-from elements are left in their place.
+//
+// scratch only lends its buffer: it is emptied and given exactly size() elements of raw
+// storage, so Type does not have to be default-constructible. The passes move-assign into
+// it, so unless Type is trivially copyable every slot is first move-constructed from the
+// element of data at the same index, which is moved straight back.
+
+template <class Type>
+template <class KeyFunc>
+void Vector<Type>::sort_by_key(KeyFunc key, Vector &scratch, size_t workers)
+{
+    using Key = std::decay_t<std::invoke_result_t<KeyFunc &, const Type &>>;
+
+    auto less = [&key](const Type &left, const Type &right)
+    {
+        return key(left) < key(right);
+    };
+
+    if (size_ < SORT_SEQUENTIAL_THRESHOLD)
+    {
+        std::sort(data_, data_ + size_, less);
+
+        return;
+    }
+
+    workers = sort_worker_count(workers, size_);
+
+    scratch.clear();
+    scratch.reserve(size_);                                                         // exactly size_
+
+    Type *raw     = scratch.data_;
+    size_t seeded = 0;                                                              // slots of raw holding an object
+    try
+    {
+        if constexpr (!std::is_trivially_copyable_v<Type>)
+        {
+            for (size_t index = 0; index < size_; ++index)
+            {
+                std::construct_at(raw + index, std::move(data_[index]));
+                seeded = index + 1;
+
+                data_[index] = std::move(raw[index]);
+            }
+        }
+
+        if constexpr (IS_RADIX_KEY<Key>)
+        {
+            parallel_radix_sort(data_, size_, key, raw, workers);
+        }
+        else
+        {
+            parallel_merge_sort(data_, size_, less, raw, workers);
+        }
+    }
+    catch (...)
+    {
+        std::destroy(raw, raw + seeded);
+
+        throw;
+    }
+
+    std::destroy(raw, raw + seeded);
+}
+
+template <class Type>
+template <class KeyFunc>
+void Vector<Type>::sort_by_key(KeyFunc key, size_t workers)
+{
+    Vector scratch;
+
+    sort_by_key(key, scratch, workers);
+}
+
+template <class Type>
+void Vector<Type>::sort(size_t workers)
+{
+    sort_by_key(std::identity(), workers);
+}
+
+
+#endif
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "views.hpp"
+
+
+//---------------------------Pipeline benchmark------------------------------------
+// Runs the same filter -> transform (-> take) pipeline eagerly, with a temporary
+// Vector after every step, and lazily through views, and prints millions of input
+// elements per second. Both must produce the same elements.
+
+const size_t BENCH_ELEMENT_BUDGET = 1 << 25;                                        // input elements per measurement
+const size_t BENCH_INPUT_SIZES[]  = {4096, 1 << 16, 1 << 22};
+
+static bool is_even(const uint32_t &value)
+{
+    return value % 2 == 0;
+}
+
+static uint64_t scale(const uint32_t &value)
+{
+    return static_cast<uint64_t> (value) * 3 + 1;
+}
+
+static Vector<uint64_t> eager_pipeline(const Vector<uint32_t> &input, size_t limit)
+{
+    Vector<uint32_t> filtered;
+    for (uint32_t value : input)
+    {
+        if (is_even(value))
+        {
+            filtered.push_back(value);
+        }
+    }
+
+    Vector<uint64_t> transformed;
+    transformed.reserve(filtered.size());
+    for (uint32_t value : filtered)
+    {
+        transformed.push_back(scale(value));
+    }
+
+    Vector<uint64_t> result;
+    result.reserve(limit < transformed.size() ? limit : transformed.size());
+    for (size_t index = 0; (index < transformed.size()) && (index < limit); ++index)
+    {
+        result.push_back(transformed[index]);
+    }
+
+    return result;
+}
+
+static Vector<uint64_t> lazy_pipeline(const Vector<uint32_t> &input, size_t limit)
+{
+    return input | filter(is_even) | transform(scale) | take(limit) | to_vector();
+}
+
+template <class Pipeline>
+static double measure_pipeline(Pipeline pipeline, const Vector<uint32_t> &input, size_t limit, Vector<uint64_t> &result)
+{
+    size_t runs = BENCH_ELEMENT_BUDGET / input.size();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t run = 0; run < runs; ++run)
+    {
+        result = pipeline(input, limit);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return static_cast<double> (runs * input.size()) / elapsed.count() / 1e6;
+}
+
+static bool bench_pipeline(const Vector<uint32_t> &input, size_t limit)
+{
+    Vector<uint64_t> eager_result;
+    Vector<uint64_t> lazy_result;
+
+    double eager_rate = measure_pipeline(eager_pipeline, input, limit, eager_result);
+    double lazy_rate  = measure_pipeline(lazy_pipeline, input, limit, lazy_result);
+
+    std::cout << std::fixed << std::setprecision(1) << "size " << input.size() << ", take "
+              << (limit < input.size() ? limit : input.size()) << ": eager " << eager_rate << ", lazy "
+              << lazy_rate << " Melements/s" << std::endl;
+
+    if (!(eager_result == lazy_result))
+    {
+        std::cerr << "ERROR: lazy pipeline produced different elements than the eager one" << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+
+int main()
+{
+    std::mt19937 generator(1);
+
+    bool passed = true;
+    for (size_t input_size : BENCH_INPUT_SIZES)
+    {
+        Vector<uint32_t> input(input_size);
+        for (uint32_t &value : input)
+        {
+            value = static_cast<uint32_t> (generator());
+        }
+
+        passed = bench_pipeline(input, input_size) && passed;                       // the whole input
+        passed = bench_pipeline(input, input_size / 16) && passed;                  // stops early
+    }
+
+    return passed ? 0 : EXIT_FAILURE;
+}
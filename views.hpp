@@ -0,0 +1,955 @@
+#ifndef VIEWS_HPP
+#define VIEWS_HPP
+
+
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+
+
+// Lazy adaptors over anything with begin()/end() (Vector, Array, other views).
+// Nothing is evaluated until the view is iterated, so a chain like
+//     data | filter(is_valid) | transform(normalize) | take(100) | to_vector()
+// walks data once and allocates only the resulting vector.
+// Views keep pointers into the underlying container, which has to outlive them.
+
+
+//---------------------------Common part-------------------------------------------
+
+// Every view iterator knows where its base ends, so all views share one end marker.
+struct ViewSentinel
+{};
+
+struct ViewBase
+{};
+
+struct AdaptorBase
+{};
+
+template <class Range>
+using RangeIterator = decltype(std::declval<const Range &>().begin());
+
+template <class Range>
+using RangeSentinel = decltype(std::declval<const Range &>().end());
+
+template <class Range>
+using RangeReference = decltype(*std::declval<RangeIterator<Range> &>());
+
+template <class Range>
+using RangeValue = std::remove_cv_t<std::remove_reference_t<RangeReference<Range>>>;
+
+
+template <class Iterator>
+class RangeView : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = std::random_access_iterator<Iterator>;
+    static const bool IS_BOUNDED = IS_SIZED;
+
+    RangeView() = default;
+
+    RangeView(Iterator first, Iterator last)
+      : first_(first),
+        last_ (last)
+    {}
+
+    Iterator begin() const
+    {
+        return first_;
+    }
+
+    Iterator end() const
+    {
+        return last_;
+    }
+
+    size_t size() const
+    {
+        return static_cast<size_t> (last_ - first_);
+    }
+
+private:
+
+    Iterator first_ = Iterator();
+    Iterator last_  = Iterator();
+};
+
+
+// A view with IS_SIZED knows its exact size(). One whose size depends on the elements
+// (a filter) may still know an upper bound through size_bound() and sets IS_BOUNDED,
+// so to_vector() can reserve once. A sized view is always bounded by its size.
+template <class View>
+size_t view_size_bound(const View &view)
+{
+    if constexpr (View::IS_SIZED)
+    {
+        return view.size();
+    }
+    else
+    {
+        return view.size_bound();
+    }
+}
+
+
+template <class Range>
+auto as_view(Range &&range)
+{
+    using Plain = std::remove_cv_t<std::remove_reference_t<Range>>;
+
+    if constexpr (std::is_base_of<ViewBase, Plain>::value)
+    {
+        return Plain(range);
+    }
+    else
+    {
+        static_assert(std::is_lvalue_reference<Range>::value, "a view over a temporary container would dangle");
+
+        return RangeView<decltype(range.begin())>(range.begin(), range.end());
+    }
+}
+
+template <class Range>
+using ViewOf = decltype(as_view(std::declval<Range>()));
+
+template <class Range, class Adaptor>
+    requires std::is_base_of<AdaptorBase, Adaptor>::value
+auto operator |(Range &&range, const Adaptor &adaptor)
+{
+    return adaptor.apply(as_view(std::forward<Range>(range)));
+}
+
+
+//---------------------------Counted iterator--------------------------------------
+// Walks at most count elements of the base; used by slice, take and chunk.
+template <class BaseIterator, class BaseSentinel>
+class CountedIterator
+{
+public:
+
+    using value_type = std::iter_value_t<BaseIterator>;
+
+    CountedIterator() = default;
+
+    CountedIterator(BaseIterator current, BaseSentinel end, size_t remaining)
+      : current_  (current),
+        end_      (end),
+        remaining_(remaining)
+    {}
+
+    decltype(auto) operator *() const
+    {
+        return *current_;
+    }
+
+    CountedIterator &operator ++()
+    {
+        ++current_;
+        --remaining_;
+
+        return *this;
+    }
+
+    bool operator ==(ViewSentinel) const
+    {
+        return (remaining_ == 0) || (!(current_ != end_));
+    }
+
+    bool operator !=(ViewSentinel sentinel) const
+    {
+        return !(*this == sentinel);
+    }
+
+private:
+
+    BaseIterator current_ = BaseIterator();
+    BaseSentinel end_     = BaseSentinel();
+    size_t remaining_     = 0;
+};
+
+template <class BaseIterator, class BaseSentinel>
+class CountedRange : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = false;
+    static const bool IS_BOUNDED = true;
+
+    CountedRange() = default;
+
+    CountedRange(BaseIterator first, BaseSentinel end, size_t count)
+      : first_(first),
+        end_  (end),
+        count_(count)
+    {}
+
+    CountedIterator<BaseIterator, BaseSentinel> begin() const
+    {
+        return CountedIterator<BaseIterator, BaseSentinel>(first_, end_, count_);
+    }
+
+    ViewSentinel end() const
+    {
+        return ViewSentinel();
+    }
+
+    size_t size_bound() const
+    {
+        return count_;
+    }
+
+private:
+
+    BaseIterator first_ = BaseIterator();
+    BaseSentinel end_   = BaseSentinel();
+    size_t count_       = 0;
+};
+
+
+//---------------------------Filter------------------------------------------------
+template <class Base, class Predicate>
+class FilterView : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = false;
+    static const bool IS_BOUNDED = Base::IS_BOUNDED;
+
+    class Iterator
+    {
+    public:
+
+        using value_type = RangeValue<Base>;
+
+        Iterator() = default;
+
+        Iterator(RangeIterator<Base> current, RangeSentinel<Base> end, const Predicate *predicate)
+          : current_  (current),
+            end_      (end),
+            predicate_(predicate)
+        {
+            skip_rejected();
+        }
+
+        decltype(auto) operator *() const
+        {
+            return *current_;
+        }
+
+        Iterator &operator ++()
+        {
+            ++current_;
+            skip_rejected();
+
+            return *this;
+        }
+
+        bool operator ==(ViewSentinel) const
+        {
+            return !(current_ != end_);
+        }
+
+        bool operator !=(ViewSentinel sentinel) const
+        {
+            return !(*this == sentinel);
+        }
+
+    private:
+
+        void skip_rejected()
+        {
+            while ((current_ != end_) && (!(*predicate_)(*current_)))
+            {
+                ++current_;
+            }
+        }
+
+        RangeIterator<Base> current_ = RangeIterator<Base>();
+        RangeSentinel<Base> end_     = RangeSentinel<Base>();
+        const Predicate *predicate_  = nullptr;
+    };
+
+    FilterView(const Base &base, const Predicate &predicate)
+      : base_     (base),
+        predicate_(predicate)
+    {}
+
+    Iterator begin() const
+    {
+        return Iterator(base_.begin(), base_.end(), &predicate_);
+    }
+
+    ViewSentinel end() const
+    {
+        return ViewSentinel();
+    }
+
+    // Every element of the base may pass.
+    size_t size_bound() const
+    {
+        return view_size_bound(base_);
+    }
+
+private:
+
+    Base base_;
+    Predicate predicate_;
+};
+
+template <class Predicate>
+struct FilterAdaptor : AdaptorBase
+{
+    template <class Base>
+    FilterView<Base, Predicate> apply(const Base &base) const
+    {
+        return FilterView<Base, Predicate>(base, predicate_);
+    }
+
+    Predicate predicate_;
+};
+
+template <class Predicate>
+FilterAdaptor<Predicate> filter(Predicate predicate)
+{
+    return FilterAdaptor<Predicate>{{}, predicate};
+}
+
+
+//---------------------------Transform---------------------------------------------
+template <class Base, class Function>
+class TransformView : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = Base::IS_SIZED;
+    static const bool IS_BOUNDED = Base::IS_BOUNDED;
+
+    class Iterator
+    {
+    public:
+
+        using value_type = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<const Function &, RangeReference<Base>>>>;
+
+        Iterator() = default;
+
+        Iterator(RangeIterator<Base> current, RangeSentinel<Base> end, const Function *function)
+          : current_ (current),
+            end_     (end),
+            function_(function)
+        {}
+
+        decltype(auto) operator *() const
+        {
+            return (*function_)(*current_);
+        }
+
+        Iterator &operator ++()
+        {
+            ++current_;
+
+            return *this;
+        }
+
+        bool operator ==(ViewSentinel) const
+        {
+            return !(current_ != end_);
+        }
+
+        bool operator !=(ViewSentinel sentinel) const
+        {
+            return !(*this == sentinel);
+        }
+
+    private:
+
+        RangeIterator<Base> current_ = RangeIterator<Base>();
+        RangeSentinel<Base> end_     = RangeSentinel<Base>();
+        const Function *function_    = nullptr;
+    };
+
+    TransformView(const Base &base, const Function &function)
+      : base_    (base),
+        function_(function)
+    {}
+
+    Iterator begin() const
+    {
+        return Iterator(base_.begin(), base_.end(), &function_);
+    }
+
+    ViewSentinel end() const
+    {
+        return ViewSentinel();
+    }
+
+    size_t size() const
+    {
+        return base_.size();
+    }
+
+    size_t size_bound() const
+    {
+        return view_size_bound(base_);
+    }
+
+private:
+
+    Base base_;
+    Function function_;
+};
+
+template <class Function>
+struct TransformAdaptor : AdaptorBase
+{
+    template <class Base>
+    TransformView<Base, Function> apply(const Base &base) const
+    {
+        return TransformView<Base, Function>(base, function_);
+    }
+
+    Function function_;
+};
+
+template <class Function>
+TransformAdaptor<Function> transform(Function function)
+{
+    return TransformAdaptor<Function>{{}, function};
+}
+
+
+//---------------------------Slice and take----------------------------------------
+// Elements with indices in [from, to) of the base.
+template <class Base>
+class SliceView : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = Base::IS_SIZED;
+    static const bool IS_BOUNDED = Base::IS_BOUNDED;
+
+    using Iterator = CountedIterator<RangeIterator<Base>, RangeSentinel<Base>>;
+
+    SliceView(const Base &base, size_t from, size_t to)
+      : base_(base),
+        from_(from),
+        to_  (to < from ? from : to)
+    {}
+
+    Iterator begin() const
+    {
+        RangeIterator<Base> first = base_.begin();
+        for (size_t skipped = 0; (skipped < from_) && (first != base_.end()); ++skipped)
+        {
+            ++first;
+        }
+
+        return Iterator(first, base_.end(), to_ - from_);
+    }
+
+    ViewSentinel end() const
+    {
+        return ViewSentinel();
+    }
+
+    size_t size() const
+    {
+        return clamp(base_.size());
+    }
+
+    size_t size_bound() const
+    {
+        return clamp(view_size_bound(base_));
+    }
+
+private:
+
+    size_t clamp(size_t base_size) const
+    {
+        size_t to = to_ < base_size ? to_ : base_size;
+
+        return from_ < to ? to - from_ : 0;
+    }
+
+    Base base_;
+    size_t from_ = 0;
+    size_t to_   = 0;
+};
+
+struct SliceAdaptor : AdaptorBase
+{
+    template <class Base>
+    SliceView<Base> apply(const Base &base) const
+    {
+        return SliceView<Base>(base, from_, to_);
+    }
+
+    size_t from_ = 0;
+    size_t to_   = 0;
+};
+
+inline SliceAdaptor slice(size_t from, size_t to)
+{
+    return SliceAdaptor{{}, from, to};
+}
+
+inline SliceAdaptor take(size_t count)
+{
+    return SliceAdaptor{{}, 0, count};
+}
+
+inline SliceAdaptor drop(size_t count)
+{
+    return SliceAdaptor{{}, count, static_cast<size_t> (-1)};
+}
+
+
+//---------------------------Stride------------------------------------------------
+template <class Base>
+class StrideView : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = Base::IS_SIZED;
+    static const bool IS_BOUNDED = Base::IS_BOUNDED;
+
+    class Iterator
+    {
+    public:
+
+        using value_type = RangeValue<Base>;
+
+        Iterator() = default;
+
+        Iterator(RangeIterator<Base> current, RangeSentinel<Base> end, size_t step)
+          : current_(current),
+            end_    (end),
+            step_   (step)
+        {}
+
+        decltype(auto) operator *() const
+        {
+            return *current_;
+        }
+
+        Iterator &operator ++()
+        {
+            for (size_t passed = 0; (passed < step_) && (current_ != end_); ++passed)
+            {
+                ++current_;
+            }
+
+            return *this;
+        }
+
+        bool operator ==(ViewSentinel) const
+        {
+            return !(current_ != end_);
+        }
+
+        bool operator !=(ViewSentinel sentinel) const
+        {
+            return !(*this == sentinel);
+        }
+
+    private:
+
+        RangeIterator<Base> current_ = RangeIterator<Base>();
+        RangeSentinel<Base> end_     = RangeSentinel<Base>();
+        size_t step_                 = 1;
+    };
+
+    StrideView(const Base &base, size_t step)
+      : base_(base),
+        step_(step == 0 ? 1 : step)
+    {}
+
+    Iterator begin() const
+    {
+        return Iterator(base_.begin(), base_.end(), step_);
+    }
+
+    ViewSentinel end() const
+    {
+        return ViewSentinel();
+    }
+
+    size_t size() const
+    {
+        return (base_.size() + step_ - 1) / step_;
+    }
+
+    size_t size_bound() const
+    {
+        return (view_size_bound(base_) + step_ - 1) / step_;
+    }
+
+private:
+
+    Base base_;
+    size_t step_ = 1;
+};
+
+struct StrideAdaptor : AdaptorBase
+{
+    template <class Base>
+    StrideView<Base> apply(const Base &base) const
+    {
+        return StrideView<Base>(base, step_);
+    }
+
+    size_t step_ = 1;
+};
+
+inline StrideAdaptor stride(size_t step)
+{
+    return StrideAdaptor{{}, step};
+}
+
+
+//---------------------------Zip---------------------------------------------------
+// Yields std::pair of references, so elements can be modified through the zip.
+template <class Base, class Other>
+class ZipView : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = Base::IS_SIZED   && Other::IS_SIZED;
+    static const bool IS_BOUNDED = Base::IS_BOUNDED && Other::IS_BOUNDED;
+
+    class Iterator
+    {
+    public:
+
+        using value_type = std::pair<RangeValue<Base>, RangeValue<Other>>;
+
+        Iterator() = default;
+
+        Iterator(RangeIterator<Base>  current,  RangeSentinel<Base>  end,
+                 RangeIterator<Other> other_current, RangeSentinel<Other> other_end)
+          : current_      (current),
+            end_          (end),
+            other_current_(other_current),
+            other_end_    (other_end)
+        {}
+
+        std::pair<RangeReference<Base>, RangeReference<Other>> operator *() const
+        {
+            return std::pair<RangeReference<Base>, RangeReference<Other>>(*current_, *other_current_);
+        }
+
+        Iterator &operator ++()
+        {
+            ++current_;
+            ++other_current_;
+
+            return *this;
+        }
+
+        bool operator ==(ViewSentinel) const
+        {
+            return (!(current_ != end_)) || (!(other_current_ != other_end_));
+        }
+
+        bool operator !=(ViewSentinel sentinel) const
+        {
+            return !(*this == sentinel);
+        }
+
+    private:
+
+        RangeIterator<Base>  current_       = RangeIterator<Base>();
+        RangeSentinel<Base>  end_           = RangeSentinel<Base>();
+        RangeIterator<Other> other_current_ = RangeIterator<Other>();
+        RangeSentinel<Other> other_end_     = RangeSentinel<Other>();
+    };
+
+    ZipView(const Base &base, const Other &other)
+      : base_ (base),
+        other_(other)
+    {}
+
+    Iterator begin() const
+    {
+        return Iterator(base_.begin(), base_.end(), other_.begin(), other_.end());
+    }
+
+    ViewSentinel end() const
+    {
+        return ViewSentinel();
+    }
+
+    size_t size() const
+    {
+        return base_.size() < other_.size() ? base_.size() : other_.size();
+    }
+
+    size_t size_bound() const
+    {
+        size_t bound       = view_size_bound(base_);
+        size_t other_bound = view_size_bound(other_);
+
+        return bound < other_bound ? bound : other_bound;
+    }
+
+private:
+
+    Base  base_;
+    Other other_;
+};
+
+template <class Other>
+struct ZipAdaptor : AdaptorBase
+{
+    template <class Base>
+    ZipView<Base, Other> apply(const Base &base) const
+    {
+        return ZipView<Base, Other>(base, other_);
+    }
+
+    Other other_;
+};
+
+template <class Range>
+ZipAdaptor<ViewOf<Range>> zip(Range &&other)
+{
+    return ZipAdaptor<ViewOf<Range>>{{}, as_view(std::forward<Range>(other))};
+}
+
+
+//---------------------------Chunk-------------------------------------------------
+// Yields consecutive pieces of chunk_size elements (the last one may be shorter).
+template <class Base>
+class ChunkView : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = Base::IS_SIZED;
+    static const bool IS_BOUNDED = Base::IS_BOUNDED;
+
+    using Chunk = CountedRange<RangeIterator<Base>, RangeSentinel<Base>>;
+
+    class Iterator
+    {
+    public:
+
+        using value_type = Chunk;
+
+        Iterator() = default;
+
+        Iterator(RangeIterator<Base> current, RangeSentinel<Base> end, size_t chunk_size)
+          : current_   (current),
+            end_       (end),
+            chunk_size_(chunk_size)
+        {}
+
+        Chunk operator *() const
+        {
+            return Chunk(current_, end_, chunk_size_);
+        }
+
+        Iterator &operator ++()
+        {
+            for (size_t passed = 0; (passed < chunk_size_) && (current_ != end_); ++passed)
+            {
+                ++current_;
+            }
+
+            return *this;
+        }
+
+        bool operator ==(ViewSentinel) const
+        {
+            return !(current_ != end_);
+        }
+
+        bool operator !=(ViewSentinel sentinel) const
+        {
+            return !(*this == sentinel);
+        }
+
+    private:
+
+        RangeIterator<Base> current_ = RangeIterator<Base>();
+        RangeSentinel<Base> end_     = RangeSentinel<Base>();
+        size_t chunk_size_           = 1;
+    };
+
+    ChunkView(const Base &base, size_t chunk_size)
+      : base_      (base),
+        chunk_size_(chunk_size == 0 ? 1 : chunk_size)
+    {}
+
+    Iterator begin() const
+    {
+        return Iterator(base_.begin(), base_.end(), chunk_size_);
+    }
+
+    ViewSentinel end() const
+    {
+        return ViewSentinel();
+    }
+
+    size_t size() const
+    {
+        return (base_.size() + chunk_size_ - 1) / chunk_size_;
+    }
+
+    size_t size_bound() const
+    {
+        return (view_size_bound(base_) + chunk_size_ - 1) / chunk_size_;
+    }
+
+private:
+
+    Base base_;
+    size_t chunk_size_ = 1;
+};
+
+struct ChunkAdaptor : AdaptorBase
+{
+    template <class Base>
+    ChunkView<Base> apply(const Base &base) const
+    {
+        return ChunkView<Base>(base, chunk_size_);
+    }
+
+    size_t chunk_size_ = 1;
+};
+
+inline ChunkAdaptor chunk(size_t chunk_size)
+{
+    return ChunkAdaptor{{}, chunk_size};
+}
+
+
+//---------------------------Enumerate---------------------------------------------
+// Yields std::pair of the index and a reference to the element.
+template <class Base>
+class EnumerateView : public ViewBase
+{
+public:
+
+    static const bool IS_SIZED   = Base::IS_SIZED;
+    static const bool IS_BOUNDED = Base::IS_BOUNDED;
+
+    class Iterator
+    {
+    public:
+
+        using value_type = std::pair<size_t, RangeValue<Base>>;
+
+        Iterator() = default;
+
+        Iterator(RangeIterator<Base> current, RangeSentinel<Base> end)
+          : current_(current),
+            end_    (end)
+        {}
+
+        std::pair<size_t, RangeReference<Base>> operator *() const
+        {
+            return std::pair<size_t, RangeReference<Base>>(index_, *current_);
+        }
+
+        Iterator &operator ++()
+        {
+            ++current_;
+            ++index_;
+
+            return *this;
+        }
+
+        bool operator ==(ViewSentinel) const
+        {
+            return !(current_ != end_);
+        }
+
+        bool operator !=(ViewSentinel sentinel) const
+        {
+            return !(*this == sentinel);
+        }
+
+    private:
+
+        RangeIterator<Base> current_ = RangeIterator<Base>();
+        RangeSentinel<Base> end_     = RangeSentinel<Base>();
+        size_t index_                = 0;
+    };
+
+    explicit EnumerateView(const Base &base)
+      : base_(base)
+    {}
+
+    Iterator begin() const
+    {
+        return Iterator(base_.begin(), base_.end());
+    }
+
+    ViewSentinel end() const
+    {
+        return ViewSentinel();
+    }
+
+    size_t size() const
+    {
+        return base_.size();
+    }
+
+    size_t size_bound() const
+    {
+        return view_size_bound(base_);
+    }
+
+private:
+
+    Base base_;
+};
+
+struct EnumerateAdaptor : AdaptorBase
+{
+    template <class Base>
+    EnumerateView<Base> apply(const Base &base) const
+    {
+        return EnumerateView<Base>(base);
+    }
+};
+
+inline EnumerateAdaptor enumerate()
+{
+    return EnumerateAdaptor();
+}
+
+
+//---------------------------Materialization---------------------------------------
+// Reserves once when the view knows its size or an upper bound of it, otherwise grows
+// as push_back does. A bound may overshoot: a filter rejecting most of a large base
+// still reserves the whole base.
+struct ToVectorAdaptor : AdaptorBase
+{
+    template <class Base>
+    Vector<std::iter_value_t<RangeIterator<Base>>> apply(const Base &base) const
+    {
+        Vector<std::iter_value_t<RangeIterator<Base>>> result;
+
+        if constexpr (Base::IS_BOUNDED)
+        {
+            result.reserve(view_size_bound(base));
+        }
+
+        for (auto iterator = base.begin(); iterator != base.end(); ++iterator)
+        {
+            result.push_back(*iterator);
+        }
+
+        return result;
+    }
+};
+
+inline ToVectorAdaptor to_vector()
+{
+    return ToVectorAdaptor();
+}
+
+
+#endif